@@ -0,0 +1,414 @@
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "gradient.hpp"
+#include "image/boost_image.hpp"
+
+namespace ItG::Benchmark {
+
+    namespace fs = std::filesystem;
+    using Clock = std::chrono::steady_clock;
+
+    /// @brief Generated image description, "WIDTHxHEIGHT:DEPTH:FORMAT", e.g. "4096x2048:16:png"
+    struct Generated {
+        ptrdiff_t width = 1024;
+        ptrdiff_t height = 1024;
+        /// @brief Bits per channel, 8 or 16. JPEG is always 8.
+        int depth = 8;
+        std::string format = "png";
+
+        std::string name() const {
+            return std::to_string(width) + "x" + std::to_string(height) + "_" + std::to_string(depth) + "." + format;
+        }
+    };
+
+    struct Options {
+        /// @brief Text file with one image path per line, relative to the manifest. Lines starting with # are skipped.
+        fs::path manifest;
+        /// @brief All files of this directory are added to the run
+        fs::path samples;
+        std::vector<Generated> generated;
+        /// @brief Generated images are written here
+        fs::path work_path = fs::temp_directory_path() / "itg-benchmark";
+        std::string_view format = "css";
+        /// @brief Runs use 1, 2, 4 ... max_threads threads
+        size_t max_threads = 0;
+        /// @brief Each image is processed this many times per run
+        size_t repeat = 3;
+        /// @brief Fit with Multiresolution of this coarse size as console --multiresolution, Collapsed<Approximate> if 0
+        size_t multiresolution = 0;
+    };
+
+    enum Stage { Decode, Sample, Fit, Serialize, StageCount };
+
+    constexpr std::string_view stage_names[StageCount] = { "decode", "sample", "fit", "serialize" };
+
+    /// @brief Stage durations of one processed image
+    struct Timing {
+        std::chrono::nanoseconds stages[StageCount]{};
+
+        std::chrono::nanoseconds total() const {
+            std::chrono::nanoseconds sum{};
+            for (auto stage : stages)
+                sum += stage;
+            return sum;
+        }
+    };
+
+    /// @brief Peak resident set size of the process in bytes, never decreases between calls.
+    /// Runs are forked on POSIX systems, so it covers a single run there.
+    size_t peak_rss() {
+#if defined(_WIN32)
+        PROCESS_MEMORY_COUNTERS counters{};
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+            return counters.PeakWorkingSetSize;
+        return 0;
+#else
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+        return static_cast<size_t>(usage.ru_maxrss);
+#else
+        return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+    }
+
+    /// @brief Parse whole text as number in [min, max]
+    template<typename T>
+    bool parse_number(std::string_view text, T& value, T min, T max) {
+        T parsed{};
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), parsed);
+        if (error != std::errc{} || end != text.data() + text.size() || parsed < min || parsed > max)
+            return false;
+        value = parsed;
+        return true;
+    }
+
+    bool parse_generated(std::string_view text, Generated& generated) {
+        // Generated side is limited, so image byte size fits
+        constexpr ptrdiff_t max_side = 1 << 16;
+
+        const size_t x = text.find('x');
+        const size_t first = text.find(':');
+        const size_t second = text.find(':', first + 1);
+        if (x == text.npos || first == text.npos || second == text.npos || x > first)
+            return false;
+
+        if (!parse_number<ptrdiff_t>(text.substr(0, x), generated.width, 1, max_side)
+            || !parse_number<ptrdiff_t>(text.substr(x + 1, first - x - 1), generated.height, 1, max_side)
+            || !parse_number(text.substr(first + 1, second - first - 1), generated.depth, 8, 16))
+            return false;
+        generated.format = text.substr(second + 1);
+
+        if (generated.format == "jpeg")
+            generated.format = "jpg";
+        if (generated.format == "jpg")
+            generated.depth = 8;
+        return generated.width > 0 && generated.height > 0
+            && (generated.depth == 8 || generated.depth == 16)
+            && (generated.format == "png" || generated.format == "jpg");
+    }
+
+    /// @brief Vertical bands over horizontal gradients with noise, so lines have both flat runs and detail
+    template<typename Image>
+    Image synthesize(ptrdiff_t width, ptrdiff_t height) {
+        using Pixel = typename Image::value_type;
+        using Channel = typename boost::gil::channel_type<Pixel>::type;
+        constexpr size_t Channels = boost::gil::num_channels<Pixel>::value;
+        const float max_value = static_cast<float>(boost::gil::channel_traits<Channel>::max_value());
+
+        std::mt19937 rng(static_cast<unsigned>(width * 31 + height));
+        std::uniform_real_distribution<float> noise(-0.02f, 0.02f);
+
+        Image image(width, height);
+        auto view = boost::gil::view(image);
+        for (ptrdiff_t y = 0; y < height; y++) {
+            auto row = view.row_begin(y);
+            for (ptrdiff_t x = 0; x < width; x++) {
+                const float u = float(x) / std::max<ptrdiff_t>(width - 1, 1);
+                const float v = float(y) / std::max<ptrdiff_t>(height - 1, 1);
+                const float band = std::floor(u * 12.f) / 12.f;
+                for (size_t c = 0; c < Channels; c++) {
+                    float value = (c == 3) ? 1.f - 0.5f * v : (u < 0.5f ? std::lerp(band, u, float(c) / 2) : std::fmod(u * (c + 1) + v, 1.f));
+                    value = std::clamp(value + (x % 7 == 0 ? noise(rng) : 0.f), 0.f, 1.f);
+                    row[x][c] = static_cast<Channel>(std::lround(value * max_value));
+                }
+            }
+        }
+        return image;
+    }
+
+    /// @brief Write generated image unless it already exists
+    fs::path generate(const Generated& generated, const fs::path& directory) {
+        fs::create_directories(directory);
+        const fs::path path = directory / generated.name();
+        if (fs::exists(path))
+            return path;
+
+        if (generated.format == "jpg") {
+            auto image = synthesize<boost::gil::rgb8_image_t>(generated.width, generated.height);
+            boost::gil::write_view(path.string(), boost::gil::const_view(image), boost::gil::jpeg_tag{});
+        } else if (generated.depth == 16) {
+            auto image = synthesize<boost::gil::rgba16_image_t>(generated.width, generated.height);
+            boost::gil::write_view(path.string(), boost::gil::const_view(image), boost::gil::png_tag{});
+        } else {
+            auto image = synthesize<boost::gil::rgba8_image_t>(generated.width, generated.height);
+            boost::gil::write_view(path.string(), boost::gil::const_view(image), boost::gil::png_tag{});
+        }
+        return path;
+    }
+
+    std::vector<fs::path> collect(const Options& options) {
+        std::vector<fs::path> images;
+
+        if (!options.manifest.empty()) {
+            std::ifstream manifest(options.manifest);
+            std::string line;
+            while (std::getline(manifest, line)) {
+                if (!line.empty() && line.back() == '\r')
+                    line.pop_back();
+                if (line.empty() || line.front() == '#')
+                    continue;
+                images.push_back(options.manifest.parent_path() / line);
+            }
+        }
+
+        if (!options.samples.empty()) {
+            std::vector<fs::path> samples;
+            for (const auto& entry : fs::directory_iterator(options.samples)) {
+                if (entry.is_regular_file())
+                    samples.push_back(entry.path());
+            }
+            std::sort(samples.begin(), samples.end());
+            images.insert(images.end(), samples.begin(), samples.end());
+        }
+
+        for (const auto& generated : options.generated)
+            images.push_back(generate(generated, options.work_path));
+
+        return images;
+    }
+
+    /// @brief Process one image through the production path, same line and strategy as the console application
+    Timing process(const fs::path& path, const Options& options, std::vector<char>& buffer, size_t& failures) {
+        Timing timing;
+        auto mark = Clock::now();
+        auto lap = [&](Stage stage) {
+            const auto now = Clock::now();
+            timing.stages[stage] = now - mark;
+            mark = now;
+        };
+
+        auto image = Image::gil::load_any(path);
+        lap(Decode);
+
+        auto linear = Image::gil::get_linear< Gradient::LinearRGBA, Image::gil::LayoutRGBA >(image, 0.0f, 0.5f, 1.0f, 0.5f);
+        image = Image::gil::AnyImage();
+        lap(Sample);
+
+        auto gradient = options.multiresolution == 0
+            ? Gradient::from_gradient<Gradient::Operator::MaxDifference>(linear, Gradient::Strategy::Collapsed<Gradient::Strategy::Approximate>{})
+            : Gradient::from_gradient<Gradient::Operator::MaxDifference>(linear, Gradient::Strategy::Collapsed<Gradient::Strategy::Multiresolution>{ .inner = { .coarse_size = options.multiresolution } });
+        lap(Fit);
+
+        if (linear.empty() || Gradient::Format::to_named(options.format, gradient, buffer).empty())
+            failures++;
+        lap(Serialize);
+
+        return timing;
+    }
+
+    std::chrono::nanoseconds percentile(std::vector<std::chrono::nanoseconds>& sorted, double fraction) {
+        if (sorted.empty())
+            return {};
+        const size_t rank = static_cast<size_t>(std::ceil(fraction * sorted.size()));
+        return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+    }
+
+    double milliseconds(std::chrono::nanoseconds duration) {
+        return duration.count() * 1e-6;
+    }
+
+    /// @brief Process all images repeat times with threads workers and print report line
+    bool run(const std::vector<fs::path>& images, const Options& options, size_t threads) {
+        const size_t count = images.size() * options.repeat;
+
+        std::vector<Timing> timings(count);
+        std::atomic<size_t> next = 0;
+        std::atomic<size_t> failures = 0;
+
+        const auto start = Clock::now();
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; t++) {
+            workers.emplace_back([&]() {
+                std::vector<char> buffer;
+                size_t failed = 0;
+                for (size_t i = next++; i < count; i = next++)
+                    timings[i] = process(images[i % images.size()], options, buffer, failed);
+                failures += failed;
+            });
+        }
+        for (auto& worker : workers)
+            worker.join();
+        const std::chrono::duration<double> elapsed = Clock::now() - start;
+
+        std::vector<std::chrono::nanoseconds> latencies;
+        std::chrono::nanoseconds stages[StageCount]{};
+        for (const auto& timing : timings) {
+            latencies.push_back(timing.total());
+            for (size_t s = 0; s < StageCount; s++)
+                stages[s] += timing.stages[s];
+        }
+        std::sort(latencies.begin(), latencies.end());
+
+        std::chrono::nanoseconds busy{};
+        for (auto stage : stages)
+            busy += stage;
+
+        std::cout << std::fixed << std::setprecision(2)
+            << std::setw(7) << threads
+            << std::setw(12) << count / elapsed.count()
+            << std::setw(10) << milliseconds(percentile(latencies, 0.5))
+            << std::setw(10) << milliseconds(percentile(latencies, 0.99))
+            << std::setw(12) << peak_rss() / double(1 << 20);
+        for (size_t s = 0; s < StageCount; s++)
+            std::cout << std::setw(11) << milliseconds(stages[s] / count) << " " << std::setw(3) << std::lround(100.0 * stages[s].count() / std::max<int64_t>(busy.count(), 1)) << "%";
+        std::cout << std::endl;
+
+        if (failures > 0)
+            std::cout << failures << " images failed" << std::endl;
+        return failures == 0;
+    }
+
+    /// @brief Run in a child process where available, so its peak RSS is not inflated by earlier runs
+    bool run_isolated(const std::vector<fs::path>& images, const Options& options, size_t threads) {
+#if defined(_WIN32)
+        return run(images, options, threads);
+#else
+        // No worker threads exist between runs, forking is safe
+        std::cout.flush();
+        const pid_t child = fork();
+        if (child < 0)
+            return run(images, options, threads);
+        if (child == 0) {
+            const bool success = run(images, options, threads);
+            std::cout.flush();
+            std::_Exit(success ? 0 : 1);
+        }
+
+        int status = 0;
+        if (waitpid(child, &status, 0) != child)
+            return false;
+        return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#endif
+    }
+
+}
+
+using namespace ItG::Benchmark;
+
+void print_usage() {
+    std::cout << "Usage: itg-benchmark [--manifest file] [--samples directory] [--generate WxH:DEPTH:png|jpg]...\n"
+        << "       [--work directory] [--threads N] [--repeat N] [--format css|svg|json|binary] [--multiresolution samples]\n"
+        << "       Replays images through load, get_linear, from_gradient and serialization at 1..N threads";
+}
+
+bool parse_options(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        if (arg == "--manifest" && i + 1 < argc) {
+            options.manifest = argv[++i];
+        } else if (arg == "--samples" && i + 1 < argc) {
+            options.samples = argv[++i];
+        } else if (arg == "--generate" && i + 1 < argc) {
+            if (!parse_generated(argv[++i], options.generated.emplace_back()))
+                return false;
+        } else if (arg == "--work" && i + 1 < argc) {
+            options.work_path = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            if (!parse_number<size_t>(argv[++i], options.max_threads, 0, 1024))
+                return false;
+        } else if (arg == "--repeat" && i + 1 < argc) {
+            if (!parse_number<size_t>(argv[++i], options.repeat, 1, 1 << 20))
+                return false;
+        } else if (arg == "--multiresolution" && i + 1 < argc) {
+            if (!parse_number<size_t>(argv[++i], options.multiresolution, 0, std::numeric_limits<size_t>::max()))
+                return false;
+        } else if (arg == "--format" && i + 1 < argc) {
+            options.format = argv[++i];
+            if (ItG::Gradient::Format::extension(options.format).empty())
+                return false;
+        } else {
+            return false;
+        }
+    }
+
+    if (options.max_threads == 0)
+        options.max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    return !options.manifest.empty() || !options.samples.empty() || !options.generated.empty();
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage();
+        return 1;
+    }
+
+    std::vector<fs::path> images;
+    try {
+        images = collect(options);
+    } catch (std::exception& e) {
+        std::cout << "Failed to prepare images: " << e.what() << std::endl;
+        return 1;
+    }
+    if (images.empty()) {
+        std::cout << "No images" << std::endl;
+        return 1;
+    }
+
+    std::cout << images.size() << " images, " << options.repeat << " repeats, " << options.format << " output\n"
+#if defined(_WIN32)
+        << "peak RSS is cumulative over runs, stage columns are mean ms per image and share of busy time\n"
+#else
+        << "each run is a separate process with its own peak RSS, stage columns are mean ms per image and share of busy time\n"
+#endif
+        << std::setw(7) << "threads" << std::setw(12) << "images/s" << std::setw(10) << "p50 ms" << std::setw(10) << "p99 ms" << std::setw(12) << "peak MiB";
+    for (auto name : stage_names)
+        std::cout << std::setw(16) << name;
+    std::cout << std::endl;
+
+    bool success = true;
+    for (size_t threads = 1;; threads = std::min(threads * 2, options.max_threads)) {
+        success = run_isolated(images, options, threads) && success;
+        if (threads == options.max_threads)
+            break;
+    }
+
+    return success ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+#ifndef ITG_H
+#define ITG_H
+
+/*
+ * C interface of image-to-gradient.
+ * All functions report errors by status code and never throw.
+ * Images are immutable once created and can be shared between threads,
+ * workspaces hold reusable buffers and must be used by one thread at a time.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  if defined(ITG_BUILD_SHARED)
+#    define ITG_API __declspec(dllexport)
+#  else
+#    define ITG_API __declspec(dllimport)
+#  endif
+#else
+#  define ITG_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Incremented on incompatible changes of this interface */
+#define ITG_ABI_VERSION 1
+
+typedef enum itg_status {
+    ITG_OK = 0,
+    ITG_ERROR_INVALID_ARGUMENT = 1,
+    /* Output buffer can't hold all keys, completed gradients are still valid */
+    ITG_ERROR_BUFFER_TOO_SMALL = 2,
+    ITG_ERROR_IO = 3,
+    ITG_ERROR_OUT_OF_MEMORY = 4,
+    ITG_ERROR_UNKNOWN = 5
+} itg_status;
+
+typedef enum itg_strategy {
+    /* Keys closer than tolerance to original, uses tolerance */
+    ITG_STRATEGY_APPROXIMATE = 0,
+    /* Exact number of keys between gradient ends, uses count */
+    ITG_STRATEGY_COLOR_COUNT = 1,
+    /* Number of extraction steps, uses count and stop_distance */
+    ITG_STRATEGY_STEP_COUNT = 2
+} itg_strategy;
+
+typedef struct itg_params {
+    itg_strategy strategy;
+    float tolerance;
+    uint32_t count;
+    float stop_distance;
+} itg_params;
+
+/* RGBA key, channels in range [0, 1] */
+typedef struct itg_key {
+    float position;
+    float color[4];
+} itg_key;
+
+/* Sampled line in unit image coordinates */
+typedef struct itg_line {
+    float x1;
+    float y1;
+    float x2;
+    float y2;
+} itg_line;
+
+/* Decoded image, kept in its native pixel type */
+typedef struct itg_image itg_image;
+
+/* Reusable buffers for fitting */
+typedef struct itg_workspace itg_workspace;
+
+ITG_API uint32_t itg_abi_version(void);
+
+ITG_API const char* itg_status_string(itg_status status);
+
+/* Default parameters of a strategy */
+ITG_API itg_params itg_default_params(itg_strategy strategy);
+
+/* Decode PNG or JPEG file, path is UTF-8 */
+ITG_API itg_status itg_image_load(const char* path, itg_image** image);
+
+/* Copy RGBA8 pixels, stride is in bytes */
+ITG_API itg_status itg_image_from_rgba8(const uint8_t* pixels, uint32_t width, uint32_t height, size_t stride, itg_image** image);
+
+ITG_API itg_status itg_image_size(const itg_image* image, uint32_t* width, uint32_t* height);
+
+ITG_API void itg_image_free(itg_image* image);
+
+ITG_API itg_status itg_workspace_create(itg_workspace** workspace);
+
+ITG_API void itg_workspace_free(itg_workspace* workspace);
+
+/*
+ * Sample and fit line_count lines of image.
+ * Keys of gradient i are written to keys[key_offsets[i] .. key_offsets[i + 1]],
+ * key_offsets must hold line_count + 1 values.
+ * fitted receives number of completed gradients, lower than line_count if keys buffer is too small.
+ */
+ITG_API itg_status itg_fit_lines(
+    itg_workspace* workspace, const itg_image* image,
+    const itg_line* lines, size_t line_count, const itg_params* params,
+    itg_key* keys, size_t key_capacity, size_t* key_offsets, size_t* fitted);
+
+/*
+ * Fit gradient_count arrays of evenly spaced RGBA colors.
+ * Colors of array i are colors[4 * color_offsets[i] .. 4 * color_offsets[i + 1]],
+ * color_offsets holds gradient_count + 1 values. Output is laid out as in itg_fit_lines.
+ */
+ITG_API itg_status itg_fit_colors(
+    itg_workspace* workspace,
+    const float* colors, const size_t* color_offsets, size_t gradient_count, const itg_params* params,
+    itg_key* keys, size_t key_capacity, size_t* key_offsets, size_t* fitted);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ITG_H */
@@ -0,0 +1,259 @@
+#include "itg.h"
+
+#include <algorithm>
+#include <array>
+#include <exception>
+#include <filesystem>
+#include <new>
+#include <span>
+#include <string_view>
+
+#include "gradient.hpp"
+#include "image/boost_image.hpp"
+
+struct itg_image {
+    ItG::Image::gil::AnyImage image;
+};
+
+struct itg_workspace {
+    using Batch = ItG::Gradient::ApproximateBatch<ItG::Gradient::LinearRGBA>;
+
+    /// Sampled or input lines of a group, reused between groups
+    std::array<ItG::Gradient::LinearRGBA, Batch::lane_count> lines;
+    /// Fitted keys of a group, reused between groups
+    std::array<ItG::Gradient::LinearRGBA, Batch::lane_count> keys;
+    /// Lockstep Approximate over a group, buffers reused between groups
+    Batch batch;
+};
+
+namespace {
+
+    using namespace ItG;
+
+    /// @brief Convert exceptions to status codes, nothing may propagate through the C interface
+    template<typename Function>
+    itg_status guarded(Function&& function) noexcept {
+        try {
+            return function();
+        } catch (const std::bad_alloc&) {
+            return ITG_ERROR_OUT_OF_MEMORY;
+        } catch (...) {
+            return ITG_ERROR_UNKNOWN;
+        }
+    }
+
+    bool is_valid(const itg_params* params) {
+        if (!params)
+            return false;
+
+        switch (params->strategy) {
+        case ITG_STRATEGY_APPROXIMATE:
+            return params->tolerance >= 0.f;
+        case ITG_STRATEGY_COLOR_COUNT:
+            return true;
+        case ITG_STRATEGY_STEP_COUNT:
+            return params->stop_distance >= 0.f && params->stop_distance <= 1.f;
+        }
+        return false;
+    }
+
+    /// @brief Fit first count lines of workspace
+    void fit(const itg_params& params, itg_workspace& workspace, size_t count) {
+        using namespace Gradient;
+
+        const Builder<LinearRGBA> builder{};
+        const auto lines = std::span(workspace.lines).first(count);
+        const auto keys = std::span(workspace.keys).first(count);
+        switch (params.strategy) {
+        case ITG_STRATEGY_APPROXIMATE:
+            workspace.batch.tolerance = params.tolerance;
+            workspace.batch(lines, keys, builder);
+            break;
+        case ITG_STRATEGY_COLOR_COUNT:
+            from_gradients<Operator::MaxDifference>(lines, keys, builder, Strategy::ColorCount{ .count = params.count });
+            break;
+        case ITG_STRATEGY_STEP_COUNT:
+            from_gradients<Operator::MaxDifference>(lines, keys, builder, Strategy::StepCount{ .count = params.count, .stop_distance = params.stop_distance });
+            break;
+        }
+    }
+
+    /// @brief Fit count gradients, fill(i, line) provides input of gradient i
+    template<typename Fill>
+    itg_status fit_batch(itg_workspace* workspace, size_t count, const itg_params* params,
+        itg_key* keys, size_t key_capacity, size_t* key_offsets, size_t* fitted, Fill&& fill) {
+
+        if (fitted)
+            *fitted = 0;
+        if (!workspace || !key_offsets || (!keys && key_capacity > 0) || !is_valid(params))
+            return ITG_ERROR_INVALID_ARGUMENT;
+
+        // Gradients are fitted in groups that run in lockstep, then copied in order
+        key_offsets[0] = 0;
+        for (size_t first = 0; first < count; first += workspace->lines.size()) {
+            const size_t group = std::min(workspace->lines.size(), count - first);
+            for (size_t g = 0; g < group; g++)
+                fill(first + g, workspace->lines[g]);
+            fit(*params, *workspace, group);
+
+            for (size_t g = 0; g < group; g++) {
+                const size_t i = first + g;
+                const auto& fitted_keys = workspace->keys[g];
+
+                const size_t offset = key_offsets[i];
+                if (fitted_keys.size() > key_capacity - offset)
+                    return ITG_ERROR_BUFFER_TOO_SMALL;
+
+                itg_key* output = keys + offset;
+                for (const auto& key : fitted_keys) {
+                    output->position = key.position;
+                    for (size_t c = 0; c < 4; c++)
+                        output->color[c] = key.color[c];
+                    ++output;
+                }
+
+                key_offsets[i + 1] = offset + fitted_keys.size();
+                if (fitted)
+                    *fitted = i + 1;
+            }
+        }
+        return ITG_OK;
+    }
+
+}
+
+uint32_t itg_abi_version(void) {
+    return ITG_ABI_VERSION;
+}
+
+const char* itg_status_string(itg_status status) {
+    switch (status) {
+    case ITG_OK: return "ok";
+    case ITG_ERROR_INVALID_ARGUMENT: return "invalid argument";
+    case ITG_ERROR_BUFFER_TOO_SMALL: return "buffer too small";
+    case ITG_ERROR_IO: return "image can't be read";
+    case ITG_ERROR_OUT_OF_MEMORY: return "out of memory";
+    case ITG_ERROR_UNKNOWN: return "unknown error";
+    }
+    return "unknown status";
+}
+
+itg_params itg_default_params(itg_strategy strategy) {
+    const Gradient::Strategy::Approximate approximate{};
+    const Gradient::Strategy::StepCount step_count{};
+
+    itg_params params{};
+    params.strategy = strategy;
+    params.tolerance = approximate.tolerance;
+    params.count = static_cast<uint32_t>(step_count.count);
+    params.stop_distance = strategy == ITG_STRATEGY_STEP_COUNT ? step_count.stop_distance : 0.f;
+    return params;
+}
+
+itg_status itg_image_load(const char* path, itg_image** image) {
+    if (!path || !image)
+        return ITG_ERROR_INVALID_ARGUMENT;
+    *image = nullptr;
+
+    return guarded([&]() {
+        auto loaded = std::make_unique<itg_image>();
+        loaded->image = Image::gil::load_any(std::filesystem::path(std::u8string_view(reinterpret_cast<const char8_t*>(path))));
+
+        const auto dimensions = loaded->image.dimensions();
+        if (dimensions.x <= 0 || dimensions.y <= 0)
+            return ITG_ERROR_IO;
+
+        *image = loaded.release();
+        return ITG_OK;
+    });
+}
+
+itg_status itg_image_from_rgba8(const uint8_t* pixels, uint32_t width, uint32_t height, size_t stride, itg_image** image) {
+    if (!pixels || !image || width == 0 || height == 0 || stride < size_t(width) * 4)
+        return ITG_ERROR_INVALID_ARGUMENT;
+    *image = nullptr;
+
+    return guarded([&]() {
+        const auto source = boost::gil::interleaved_view(width, height, reinterpret_cast<const boost::gil::rgba8_pixel_t*>(pixels), stride);
+
+        boost::gil::rgba8_image_t copy(width, height);
+        boost::gil::copy_pixels(source, boost::gil::view(copy));
+
+        auto created = std::make_unique<itg_image>();
+        created->image = std::move(copy);
+        *image = created.release();
+        return ITG_OK;
+    });
+}
+
+itg_status itg_image_size(const itg_image* image, uint32_t* width, uint32_t* height) {
+    if (!image || !width || !height)
+        return ITG_ERROR_INVALID_ARGUMENT;
+
+    const auto dimensions = image->image.dimensions();
+    *width = static_cast<uint32_t>(dimensions.x);
+    *height = static_cast<uint32_t>(dimensions.y);
+    return ITG_OK;
+}
+
+void itg_image_free(itg_image* image) {
+    delete image;
+}
+
+itg_status itg_workspace_create(itg_workspace** workspace) {
+    if (!workspace)
+        return ITG_ERROR_INVALID_ARGUMENT;
+    *workspace = nullptr;
+
+    return guarded([&]() {
+        *workspace = new itg_workspace{};
+        return ITG_OK;
+    });
+}
+
+void itg_workspace_free(itg_workspace* workspace) {
+    delete workspace;
+}
+
+itg_status itg_fit_lines(
+    itg_workspace* workspace, const itg_image* image,
+    const itg_line* lines, size_t line_count, const itg_params* params,
+    itg_key* keys, size_t key_capacity, size_t* key_offsets, size_t* fitted) {
+
+    if (!image || (!lines && line_count > 0))
+        return ITG_ERROR_INVALID_ARGUMENT;
+
+    return guarded([&]() {
+        return fit_batch(workspace, line_count, params, keys, key_capacity, key_offsets, fitted, [&](size_t i, Gradient::LinearRGBA& line) {
+            const itg_line& sampled = lines[i];
+            Image::gil::get_linear_into<Gradient::LinearRGBA, Image::gil::LayoutRGBA>(image->image, sampled.x1, sampled.y1, sampled.x2, sampled.y2, line);
+        });
+    });
+}
+
+itg_status itg_fit_colors(
+    itg_workspace* workspace,
+    const float* colors, const size_t* color_offsets, size_t gradient_count, const itg_params* params,
+    itg_key* keys, size_t key_capacity, size_t* key_offsets, size_t* fitted) {
+
+    if (!color_offsets || (!colors && gradient_count > 0))
+        return ITG_ERROR_INVALID_ARGUMENT;
+    for (size_t i = 0; i < gradient_count; i++) {
+        if (color_offsets[i + 1] < color_offsets[i])
+            return ITG_ERROR_INVALID_ARGUMENT;
+    }
+
+    return guarded([&]() {
+        return fit_batch(workspace, gradient_count, params, keys, key_capacity, key_offsets, fitted, [&](size_t i, Gradient::LinearRGBA& line) {
+            // Evenly spaced like from_colors
+            const size_t first = color_offsets[i];
+            const size_t count = color_offsets[i + 1] - first;
+
+            line.clear();
+            for (size_t c = 0; c < count; c++) {
+                const float* color = colors + 4 * (first + c);
+                line.emplace_back(Color::RGBA{ color[0], color[1], color[2], color[3] }, count > 1 ? c / float(count - 1) : 0.f);
+            }
+        });
+    });
+}
@@ -0,0 +1,178 @@
+/*
+ * Smoke test of the C interface, compiled as C so the header is checked without C++.
+ * Exits with 0 if every check passes, prints failed checks otherwise.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "itg.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++; \
+        } \
+    } while (0)
+
+enum { WIDTH = 64, HEIGHT = 4, LINE_COUNT = 4, KEY_CAPACITY = 64 };
+
+static void check_status_strings(void) {
+    itg_status status;
+    for (status = ITG_OK; status <= ITG_ERROR_UNKNOWN; status++)
+        CHECK(itg_status_string(status) != NULL);
+}
+
+static void check_images(itg_image** image) {
+    static uint8_t pixels[HEIGHT][WIDTH][4];
+    uint32_t width = 0, height = 0;
+    int x, y;
+
+    /* Red to blue ramp */
+    for (y = 0; y < HEIGHT; y++) {
+        for (x = 0; x < WIDTH; x++) {
+            pixels[y][x][0] = (uint8_t)(255 - x * 4);
+            pixels[y][x][1] = 0;
+            pixels[y][x][2] = (uint8_t)(x * 4);
+            pixels[y][x][3] = 255;
+        }
+    }
+
+    CHECK(itg_image_load(NULL, image) == ITG_ERROR_INVALID_ARGUMENT);
+    CHECK(itg_image_load("missing.png", NULL) == ITG_ERROR_INVALID_ARGUMENT);
+    CHECK(itg_image_load("missing.png", image) == ITG_ERROR_IO);
+    CHECK(*image == NULL);
+
+    CHECK(itg_image_from_rgba8(NULL, WIDTH, HEIGHT, WIDTH * 4, image) == ITG_ERROR_INVALID_ARGUMENT);
+    CHECK(itg_image_from_rgba8(&pixels[0][0][0], 0, HEIGHT, WIDTH * 4, image) == ITG_ERROR_INVALID_ARGUMENT);
+    CHECK(itg_image_from_rgba8(&pixels[0][0][0], WIDTH, HEIGHT, WIDTH * 4 - 1, image) == ITG_ERROR_INVALID_ARGUMENT);
+    CHECK(itg_image_from_rgba8(&pixels[0][0][0], WIDTH, HEIGHT, WIDTH * 4, image) == ITG_OK);
+    CHECK(*image != NULL);
+
+    CHECK(itg_image_size(NULL, &width, &height) == ITG_ERROR_INVALID_ARGUMENT);
+    CHECK(itg_image_size(*image, NULL, &height) == ITG_ERROR_INVALID_ARGUMENT);
+    CHECK(itg_image_size(*image, &width, &height) == ITG_OK);
+    CHECK(width == WIDTH && height == HEIGHT);
+}
+
+static void check_fit_lines(itg_workspace* workspace, const itg_image* image) {
+    itg_params params = itg_default_params(ITG_STRATEGY_APPROXIMATE);
+    itg_line lines[LINE_COUNT];
+    itg_key keys[KEY_CAPACITY];
+    size_t key_offsets[LINE_COUNT + 1];
+    size_t fitted = 0;
+    size_t i;
+
+    for (i = 0; i < LINE_COUNT; i++) {
+        lines[i].x1 = 0.f;
+        lines[i].x2 = 1.f;
+        lines[i].y1 = lines[i].y2 = (i + 0.5f) / LINE_COUNT;
+    }
+
+    CHECK(itg_fit_lines(workspace, image, lines, LINE_COUNT, &params, keys, KEY_CAPACITY, key_offsets, &fitted) == ITG_OK);
+    CHECK(fitted == LINE_COUNT);
+    CHECK(key_offsets[0] == 0);
+    for (i = 0; i < fitted; i++) {
+        const itg_key* first = keys + key_offsets[i];
+        const itg_key* last = keys + key_offsets[i + 1] - 1;
+        CHECK(key_offsets[i + 1] >= key_offsets[i] + 2);
+        CHECK(first->position == 0.f && last->position == 1.f);
+        CHECK(first->color[0] > 0.9f && first->color[2] < 0.1f);
+        CHECK(last->color[0] < 0.1f && last->color[2] > 0.9f);
+    }
+
+    /* Keys of completed gradients stay valid when the buffer runs out */
+    CHECK(itg_fit_lines(workspace, image, lines, LINE_COUNT, &params, keys, 3, key_offsets, &fitted) == ITG_ERROR_BUFFER_TOO_SMALL);
+    CHECK(fitted < LINE_COUNT);
+    CHECK(key_offsets[fitted] <= 3);
+
+    CHECK(itg_fit_lines(workspace, NULL, lines, LINE_COUNT, &params, keys, KEY_CAPACITY, key_offsets, &fitted) == ITG_ERROR_INVALID_ARGUMENT);
+    CHECK(itg_fit_lines(workspace, image, NULL, LINE_COUNT, &params, keys, KEY_CAPACITY, key_offsets, &fitted) == ITG_ERROR_INVALID_ARGUMENT);
+    CHECK(itg_fit_lines(NULL, image, lines, LINE_COUNT, &params, keys, KEY_CAPACITY, key_offsets, &fitted) == ITG_ERROR_INVALID_ARGUMENT);
+    CHECK(fitted == 0);
+    CHECK(itg_fit_lines(workspace, image, lines, LINE_COUNT, NULL, keys, KEY_CAPACITY, key_offsets, &fitted) == ITG_ERROR_INVALID_ARGUMENT);
+    CHECK(itg_fit_lines(workspace, image, lines, LINE_COUNT, &params, keys, KEY_CAPACITY, NULL, &fitted) == ITG_ERROR_INVALID_ARGUMENT);
+    CHECK(itg_fit_lines(workspace, image, lines, LINE_COUNT, &params, NULL, KEY_CAPACITY, key_offsets, &fitted) == ITG_ERROR_INVALID_ARGUMENT);
+
+    /* Nothing to fit needs no buffers, fitted is optional */
+    CHECK(itg_fit_lines(workspace, image, NULL, 0, &params, NULL, 0, key_offsets, NULL) == ITG_OK);
+    CHECK(key_offsets[0] == 0);
+}
+
+static void check_fit_colors(itg_workspace* workspace) {
+    /* Linear ramp, then red-green-red */
+    static const float colors[] = {
+        0.f, 0.f, 0.f, 1.f,   .5f, .5f, .5f, 1.f,   1.f, 1.f, 1.f, 1.f,
+        1.f, 0.f, 0.f, 1.f,   0.f, 1.f, 0.f, 1.f,   1.f, 0.f, 0.f, 1.f
+    };
+    const size_t color_offsets[] = { 0, 3, 6 };
+    const size_t reversed_offsets[] = { 3, 0, 6 };
+    itg_params params = itg_default_params(ITG_STRATEGY_APPROXIMATE);
+    itg_key keys[KEY_CAPACITY];
+    size_t key_offsets[3];
+    size_t fitted = 0;
+
+    CHECK(itg_fit_colors(workspace, colors, color_offsets, 2, &params, keys, KEY_CAPACITY, key_offsets, &fitted) == ITG_OK);
+    CHECK(fitted == 2);
+    CHECK(key_offsets[1] == 2 && key_offsets[2] == 5);
+    CHECK(keys[3].position == .5f && keys[3].color[1] == 1.f);
+
+    params = itg_default_params(ITG_STRATEGY_COLOR_COUNT);
+    params.count = 1;
+    CHECK(itg_fit_colors(workspace, colors, color_offsets, 2, &params, keys, KEY_CAPACITY, key_offsets, &fitted) == ITG_OK);
+    CHECK(fitted == 2);
+    CHECK(key_offsets[1] == 3 && key_offsets[2] == 6);
+
+    params = itg_default_params(ITG_STRATEGY_APPROXIMATE);
+    params.tolerance = -1.f;
+    CHECK(itg_fit_colors(workspace, colors, color_offsets, 2, &params, keys, KEY_CAPACITY, key_offsets, &fitted) == ITG_ERROR_INVALID_ARGUMENT);
+    CHECK(fitted == 0);
+
+    params = itg_default_params(ITG_STRATEGY_STEP_COUNT);
+    params.stop_distance = 2.f;
+    CHECK(itg_fit_colors(workspace, colors, color_offsets, 2, &params, keys, KEY_CAPACITY, key_offsets, &fitted) == ITG_ERROR_INVALID_ARGUMENT);
+
+    params = itg_default_params(ITG_STRATEGY_APPROXIMATE);
+    CHECK(itg_fit_colors(workspace, colors, reversed_offsets, 2, &params, keys, KEY_CAPACITY, key_offsets, &fitted) == ITG_ERROR_INVALID_ARGUMENT);
+    CHECK(itg_fit_colors(workspace, NULL, color_offsets, 2, &params, keys, KEY_CAPACITY, key_offsets, &fitted) == ITG_ERROR_INVALID_ARGUMENT);
+    CHECK(itg_fit_colors(workspace, colors, NULL, 2, &params, keys, KEY_CAPACITY, key_offsets, &fitted) == ITG_ERROR_INVALID_ARGUMENT);
+
+    /* Second gradient doesn't fit, first one is complete */
+    CHECK(itg_fit_colors(workspace, colors, color_offsets, 2, &params, keys, 4, key_offsets, &fitted) == ITG_ERROR_BUFFER_TOO_SMALL);
+    CHECK(fitted == 1);
+    CHECK(key_offsets[1] == 2);
+}
+
+int main(void) {
+    itg_image* image = NULL;
+    itg_workspace* workspace = NULL;
+
+    CHECK(itg_abi_version() == ITG_ABI_VERSION);
+    check_status_strings();
+
+    CHECK(itg_workspace_create(NULL) == ITG_ERROR_INVALID_ARGUMENT);
+    CHECK(itg_workspace_create(&workspace) == ITG_OK);
+    CHECK(workspace != NULL);
+
+    check_images(&image);
+    if (workspace && image) {
+        check_fit_lines(workspace, image);
+        check_fit_colors(workspace);
+    }
+
+    itg_image_free(image);
+    itg_workspace_free(workspace);
+    /* Freeing null handles is allowed */
+    itg_image_free(NULL);
+    itg_workspace_free(NULL);
+
+    if (failures)
+        fprintf(stderr, "%d checks failed\n", failures);
+    else
+        printf("PASSED\n");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,241 @@
+﻿#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gradient.hpp"
+
+namespace ItG::Calibrate {
+
+    namespace fs = std::filesystem;
+    using Clock = std::chrono::steady_clock;
+    using Gradient::Strategy::CostTable;
+    using Gradient::Strategy::Kernel;
+    using Gradient::Strategy::kernel_count;
+    using Gradient::Strategy::kernel_names;
+
+    struct Options {
+        /// @brief Generated header is written here, printed if empty
+        fs::path output;
+        /// @brief Measured time per kernel and cell
+        std::chrono::milliseconds budget{ 20 };
+        /// @brief Different lines per cell
+        size_t lines = 16;
+        /// @brief Key count target for ColorCount kernels
+        size_t count = 8;
+    };
+
+    template<size_t N>
+    using LinearN = std::vector< Gradient::Key< std::array<float, N> > >;
+
+    /// @brief Piecewise linear line with uniform noise of given second difference variance,
+    /// each key repeats its predecessor with probability run_ratio
+    template<size_t N>
+    LinearN<N> generate(std::mt19937& rng, size_t length, float run_ratio, float variance) {
+        std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+        std::array< std::array<float, N>, 5 > anchors;
+        for (auto& anchor : anchors)
+            for (auto& value : anchor)
+                value = unit(rng);
+
+        // Second difference of independent noise has 6 times its variance, uniform noise of amplitude a has a^2 / 3
+        const float amplitude = std::sqrt(variance / 2.f);
+        std::uniform_real_distribution<float> noise(-amplitude, amplitude);
+
+        LinearN<N> line;
+        line.reserve(length);
+        for (size_t i = 0; i < length; i++) {
+            const float position = float(i) / (length - 1);
+            if (i > 0 && unit(rng) < run_ratio) {
+                line.emplace_back(line.back().color, position);
+                continue;
+            }
+
+            const float segment = position * (anchors.size() - 1);
+            const size_t index = std::min(static_cast<size_t>(segment), anchors.size() - 2);
+            std::array<float, N> color;
+            for (size_t c = 0; c < N; c++)
+                color[c] = std::clamp(std::lerp(anchors[index][c], anchors[index + 1][c], segment - index) + noise(rng), 0.f, 1.f);
+            line.emplace_back(color, position);
+        }
+        return line;
+    }
+
+    /// @brief Nanoseconds per gradient of kernel, best of three runs of at least budget each
+    template<size_t N>
+    float measure(std::vector< LinearN<N> >& lines, Kernel kernel, const Options& options) {
+        using namespace Gradient;
+
+        const Strategy::Auto strategy{ .count = options.count, .kernel = kernel };
+        LinearN<N> output;
+        size_t keys = 0;
+
+        double best = std::numeric_limits<double>::max();
+        for (int run = 0; run < 3; run++) {
+            size_t gradients = 0;
+            const auto start = Clock::now();
+            auto elapsed = Clock::duration::zero();
+            do {
+                for (auto& line : lines) {
+                    from_gradient_into<Operator::MaxDifference>(line, output, {}, strategy);
+                    keys += output.size();
+                }
+                gradients += lines.size();
+                elapsed = Clock::now() - start;
+            } while (elapsed < options.budget);
+
+            best = std::min(best, std::chrono::duration<double, std::nano>(elapsed).count() / gradients);
+        }
+
+        // Keeps extraction from being optimized out
+        if (keys == 0)
+            std::cout << "";
+        return static_cast<float>(best);
+    }
+
+    template<size_t N>
+    void calibrate(size_t channel_index, const Options& options, CostTable& table) {
+        std::mt19937 rng(static_cast<uint32_t>(N));
+
+        for (size_t l = 0; l < CostTable::lengths.size(); l++) {
+            for (size_t r = 0; r < CostTable::run_ratios.size(); r++) {
+                for (size_t v = 0; v < CostTable::variances.size(); v++) {
+                    std::vector< LinearN<N> > lines;
+                    for (size_t i = 0; i < options.lines; i++)
+                        lines.push_back(generate<N>(rng, CostTable::lengths[l], CostTable::run_ratios[r], CostTable::variances[v]));
+
+                    auto& cell = table.costs[CostTable::cell(channel_index, l, r, v)];
+                    for (size_t k = 0; k < kernel_count; k++)
+                        cell[k] = measure<N>(lines, Kernel(k), options);
+
+                    const Gradient::Strategy::Profile profile{ .length = CostTable::lengths[l], .channels = N, .run_ratio = CostTable::run_ratios[r], .variance = CostTable::variances[v] };
+                    std::cout << std::setw(3) << N << std::setw(7) << CostTable::lengths[l] << std::setw(6) << CostTable::run_ratios[r] << std::setw(8) << CostTable::variances[v]
+                        << "  " << std::setw(24) << std::left << kernel_names[size_t(table.select(profile, false))]
+                        << std::setw(24) << kernel_names[size_t(table.select(profile, true))] << std::right;
+                    for (float cost : cell)
+                        std::cout << std::setw(12) << std::fixed << std::setprecision(0) << cost;
+                    std::cout << std::defaultfloat << std::endl;
+                }
+            }
+        }
+    }
+
+    /// @brief Source of auto_costs.hpp
+    std::string header(const CostTable& table) {
+        std::ostringstream out;
+        out << "\xEF\xBB\xBF#pragma once\n\n"
+            << "#include <array>\n\n"
+            << "// Generated by itg-calibrate, regenerate on target machine:\n"
+            << "//     itg-calibrate --output include/gradient/strategy/auto_costs.hpp\n\n"
+            << "namespace ItG::Gradient::Strategy::Calibration {\n\n"
+            << "    /// @brief Nanoseconds per gradient of";
+        for (size_t k = 0; k < kernel_count; k++)
+            out << (k ? ", " : " ") << kernel_names[k];
+        out << ",\n"
+            << "    /// by [channels][length][run ratio][variance], see CostTable\n"
+            << "    inline constexpr std::array<std::array<float, " << kernel_count << ">, " << CostTable::cell_count << "> costs{ {\n";
+
+        for (size_t c = 0; c < CostTable::channels.size(); c++)
+            for (size_t l = 0; l < CostTable::lengths.size(); l++)
+                for (size_t r = 0; r < CostTable::run_ratios.size(); r++)
+                    for (size_t v = 0; v < CostTable::variances.size(); v++) {
+                        out << "        // " << CostTable::channels[c] << " channels, " << CostTable::lengths[l] << " keys, run ratio "
+                            << CostTable::run_ratios[r] << ", variance " << CostTable::variances[v] << "\n        {";
+                        const auto& cell = table.costs[CostTable::cell(c, l, r, v)];
+                        for (size_t k = 0; k < kernel_count; k++)
+                            out << (k ? ", " : " ") << std::fixed << std::setprecision(0) << cell[k] << ".f" << std::defaultfloat;
+                        out << " },\n";
+                    }
+
+        out << "    } };\n\n"
+            << "}\n";
+        return out.str();
+    }
+
+}
+
+using namespace ItG::Calibrate;
+
+void print_usage() {
+    std::cout << "Usage: itg-calibrate [--output auto_costs.hpp] [--budget ms] [--lines N] [--count N]\n"
+        << "       Measures every Auto kernel on generated lines of each profile class and writes the cost table";
+}
+
+/// @brief Parse whole argument as unsigned number in [min, max]
+bool parse_number(std::string_view text, size_t& value, size_t min, size_t max) {
+    size_t parsed = 0;
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), parsed);
+    if (error != std::errc{} || end != text.data() + text.size() || parsed < min || parsed > max)
+        return false;
+    value = parsed;
+    return true;
+}
+
+bool parse_options(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        bool valid = true;
+        if (arg == "--output" && i + 1 < argc) {
+            options.output = argv[++i];
+        } else if (arg == "--budget" && i + 1 < argc) {
+            size_t budget = 0;
+            valid = parse_number(argv[++i], budget, 1, 60 * 60 * 1000);
+            options.budget = std::chrono::milliseconds(budget);
+        } else if (arg == "--lines" && i + 1 < argc) {
+            valid = parse_number(argv[++i], options.lines, 1, 1 << 20);
+        } else if (arg == "--count" && i + 1 < argc) {
+            valid = parse_number(argv[++i], options.count, 1, 1 << 20);
+        } else {
+            return false;
+        }
+
+        if (!valid)
+            return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage();
+        return 1;
+    }
+
+    static_assert(CostTable::channels[0] == 1 && CostTable::channels[1] == 3 && CostTable::channels[2] == 4);
+
+    std::cout << "channels length runs variance  tolerance target         count target, ns per gradient of";
+    for (auto name : kernel_names)
+        std::cout << " " << name;
+    std::cout << std::endl;
+
+    CostTable table{};
+    calibrate<1>(0, options, table);
+    calibrate<3>(1, options, table);
+    calibrate<4>(2, options, table);
+
+    const std::string source = header(table);
+    if (options.output.empty()) {
+        std::cout << source;
+        return 0;
+    }
+
+    std::ofstream output(options.output, std::ios::binary);
+    output << source;
+    if (!output) {
+        std::cout << "Failed to write " << options.output.string() << std::endl;
+        return 1;
+    }
+    std::cout << "Written " << options.output.string() << std::endl;
+    return 0;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+#include "gradient.hpp"
+
+namespace ItG::Console {
+
+    struct Options {
+        std::vector<std::filesystem::path> image_paths;
+        std::filesystem::path output_path;
+        std::string_view format = "css";
+        /// @brief Decode image in tiles under this budget (MiB), whole image is decoded if 0
+        size_t memory_budget = 0;
+        /// @brief Decode JPEG at reduced resolution keeping at least this many pixels along the sampled line, full resolution if 0.
+        /// Takes precedence over memory_budget.
+        size_t coarse_size = 0;
+        /// @brief Fit lines of at least twice this many samples coarse-to-fine with Multiresolution, keys may differ from Approximate.
+        /// Lines are fitted with Collapsed<Approximate> if 0.
+        size_t multiresolution = 0;
+
+        /// @brief Batch mode threads per stage
+        size_t decode_threads = 2;
+        size_t sample_threads = 1;
+        size_t fit_threads = 0;
+        size_t serialize_threads = 1;
+        size_t queue_depth = 16;
+        /// @brief Print batch stage metrics
+        bool metrics = false;
+        /// @brief Keep fitting results in this directory and reuse them for identical lines, disabled if empty
+        std::filesystem::path cache_path;
+        /// @brief Read CSS or SVG gradients from image_paths and write simplified gradients into output_path
+        bool simplify = false;
+        /// @brief Watch image_paths directories and refit changed images
+        bool watch = false;
+        /// @brief Watch mode waits this long after last change before refitting
+        size_t debounce_ms = 300;
+        /// @brief Write Chrome trace to this file if not empty, requires build with IMAGE_TO_GRADIENT_TRACE
+        std::filesystem::path trace_path;
+    };
+
+    /// @brief Sample gradient line from image
+    Gradient::LinearRGBA sample(const Options& options, const std::filesystem::path& image_path);
+
+    using Cache = Gradient::ResultCache<Gradient::LinearRGBA>;
+
+    /// @brief Fit gradient to sampled line with strategy selected by options
+    /// @param cache Result cache, optional
+    Gradient::LinearRGBA fit(const Options& options, Gradient::LinearRGBA& linear, Cache* cache = nullptr);
+
+    /// @brief Print cache hit/miss counters
+    void print_statistics(const Cache& cache);
+
+    /// @brief Output file name of an image in batch and watch mode, image file name with format extension appended (x.png -> x.png.css).
+    /// Images of different type but same stem get different outputs, images of same name in different directories still collide.
+    std::filesystem::path output_name(const Options& options, const std::filesystem::path& image_path);
+
+    /// @brief Process all images in options.image_paths into options.output_path directory
+    int run_batch(const Options& options, Cache* cache);
+
+    /// @brief Simplify all CSS linear-gradient() or SVG <linearGradient> gradients in options.image_paths files (.svg files are read as SVG).
+    /// Results are written into options.output_path file, one per line for text formats.
+    int run_simplify(const Options& options, Cache* cache);
+
+    /// @brief Keep options.output_path up to date with images in options.image_paths directories until interrupted.
+    /// Content hashes of processed images are kept in output directory, so only changed images are refitted after restart.
+    int run_watch(const Options& options, Cache* cache);
+
+}
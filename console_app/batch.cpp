@@ -0,0 +1,141 @@
+#include <iostream>
+#include <fstream>
+#include <map>
+#include <memory>
+
+#include "app.hpp"
+#include "image/boost_image.hpp"
+#include "image/scaled_image.hpp"
+#include "image/tiled_image.hpp"
+#include "pipeline/pipeline.hpp"
+
+namespace ItG::Console {
+
+    /// @brief Single image passing through batch pipeline
+    struct Job {
+        std::filesystem::path image_path;
+        std::filesystem::path output_path;
+        Image::gil::AnyImage image;
+        Gradient::LinearRGBA linear;
+        Gradient::LinearRGBA gradient;
+        /// @brief A stage failed, job is only reported
+        bool failed = false;
+    };
+
+    using JobPtr = std::unique_ptr<Job>;
+
+    void print_metrics(const Pipeline::Executor& executor, std::chrono::duration<double> elapsed, size_t count) {
+        std::cout << count << " images in " << elapsed.count() << " s, " << count / elapsed.count() << " images/s\n";
+        for (const auto& stage : executor.metrics()) {
+            std::cout << stage.name << ": " << stage.threads << " threads, "
+                << stage.processed.load() << " processed, "
+                << stage.failed.load() << " failed, "
+                << stage.busy_ns.load() * 1e-6 << " ms busy, "
+                << stage.wait_ns.load() * 1e-6 << " ms waiting, "
+                << "input queue max depth " << stage.input_depth() << "/" << stage.input_capacity << "\n";
+        }
+    }
+
+    int run_batch(const Options& options, Cache* cache) {
+        using Clock = std::chrono::steady_clock;
+
+        std::filesystem::create_directories(options.output_path);
+
+        Pipeline::BoundedQueue<JobPtr> pending(options.queue_depth);
+        Pipeline::BoundedQueue<JobPtr> decoded(options.queue_depth);
+        Pipeline::BoundedQueue<JobPtr> sampled(options.queue_depth);
+        Pipeline::BoundedQueue<JobPtr> fitted(options.queue_depth);
+
+        Pipeline::Executor executor;
+        std::atomic<size_t> failed = 0;
+
+        auto start = Clock::now();
+
+        // Job a stage threw on is passed on as failed and reported by the sink
+        auto fail = [](JobPtr&& job) {
+            job->failed = true;
+            return std::move(job);
+        };
+
+        executor.add_stage("decode", options.decode_threads, pending, decoded, [&](JobPtr&& job) {
+            // Tiled images are decoded while sampling
+            if (options.coarse_size > 0)
+                job->image = Image::gil::load_scaled(job->image_path, options.coarse_size, 0).image;
+            else if (options.memory_budget == 0)
+                job->image = Image::gil::load_any(job->image_path);
+            return std::move(job);
+        }, fail);
+
+        executor.add_stage("sample", options.sample_threads, decoded, sampled, [&](JobPtr&& job) {
+            if (job->failed)
+                return std::move(job);
+            if (options.memory_budget > 0 && options.coarse_size == 0) {
+                job->linear = sample(options, job->image_path);
+            } else {
+                job->linear = Image::gil::get_linear< Gradient::LinearRGBA, Image::gil::LayoutRGBA >(job->image, 0.0f, 0.5f, 1.0f, 0.5f);
+                // Release image memory before fitting
+                job->image = Image::gil::AnyImage();
+            }
+            job->failed = job->linear.empty();
+            return std::move(job);
+        }, fail);
+
+        executor.add_stage("fit", options.fit_threads, sampled, fitted, [&](JobPtr&& job) {
+            if (job->failed)
+                return std::move(job);
+            job->gradient = fit(options, job->linear, cache);
+            job->linear = Gradient::LinearRGBA();
+            return std::move(job);
+        }, fail);
+
+        // Each serialize thread has its own copy of buffer
+        executor.add_sink("serialize", options.serialize_threads, fitted, [&, buffer = std::vector<char>{}](JobPtr&& job) mutable {
+            if (job->failed) {
+                std::cout << "Failed to process " << job->image_path.string() << std::endl;
+                failed++;
+                return;
+            }
+
+            const std::string_view result = Gradient::Format::to_named(options.format, job->gradient, buffer);
+            std::ofstream output_file(job->output_path, std::ios::binary);
+            if (result.empty() || !output_file) {
+                std::cout << "Failed to process " << job->image_path.string() << std::endl;
+                failed++;
+                return;
+            }
+            output_file.write(result.data(), result.size());
+        }, [&](JobPtr&& job) {
+            std::cout << "Failed to process " << job->image_path.string() << std::endl;
+            failed++;
+        });
+
+        // Output owners, an image whose output is already owned is not processed
+        std::map<std::filesystem::path, std::filesystem::path> outputs;
+        for (const auto& image_path : options.image_paths) {
+            auto job = std::make_unique<Job>();
+            job->image_path = image_path;
+            job->output_path = options.output_path / output_name(options, image_path);
+
+            auto [owner, inserted] = outputs.emplace(job->output_path, image_path);
+            if (!inserted) {
+                std::cout << "Failed to process " << image_path.string() << ", output " << job->output_path.string()
+                    << " belongs to " << owner->second.string() << std::endl;
+                failed++;
+                continue;
+            }
+            pending.push(std::move(job));
+        }
+        pending.close();
+
+        executor.wait();
+
+        if (options.metrics) {
+            print_metrics(executor, Clock::now() - start, options.image_paths.size());
+            if (cache)
+                print_statistics(*cache);
+        }
+
+        return failed > 0 ? 1 : 0;
+    }
+
+}
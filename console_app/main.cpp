@@ -1,42 +1,209 @@
-﻿#include <iostream>
-#include <sstream>
+﻿#include <charconv>
+#include <iostream>
+#include <fstream>
+#include <limits>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <memory>
 
-#include "gradient.hpp"
+#include "app.hpp"
 #include "image/boost_image.hpp"
+#include "image/scaled_image.hpp"
+#include "image/tiled_image.hpp"
+#include "trace/trace.hpp"
 
-int main(int argc, char** argv) {
-    if (argc != 3) {
-        std::cout << "Usage: image-to-gradient image_path output_path";
-        return 1;
+namespace ItG::Console {
+
+    Gradient::LinearRGBA sample(const Options& options, const std::filesystem::path& image_path) {
+        if (options.coarse_size > 0) {
+            auto scaled = Image::gil::load_scaled(image_path, options.coarse_size, 0);
+            return Image::gil::get_linear< Gradient::LinearRGBA, Image::gil::LayoutRGBA >(scaled.image, 0.0f, 0.5f, 1.0f, 0.5f);
+        }
+
+        if (options.memory_budget > 0) {
+            Image::gil::TiledSource<Image::gil::LayoutRGBA> source(image_path, { .memory_budget = options.memory_budget << 20 });
+            return Image::gil::get_linear< Gradient::LinearRGBA >(source, 0.0f, 0.5f, 1.0f, 0.5f);
+        }
+
+        auto image = Image::gil::load_any(image_path);
+        return Image::gil::get_linear< Gradient::LinearRGBA, Image::gil::LayoutRGBA >(image, 0.0f, 0.5f, 1.0f, 0.5f);
     }
 
-    std::filesystem::path image_path = argv[1];
-    std::filesystem::path output_path = argv[2];
+    Gradient::LinearRGBA fit(const Options& options, Gradient::LinearRGBA& linear, Cache* cache) {
+        auto fit_with = [&]<typename Strategy>(const Strategy& strategy) {
+            if (cache)
+                return Gradient::from_gradient<Gradient::Operator::MaxDifference>(*cache, linear, strategy);
+            return Gradient::from_gradient<Gradient::Operator::MaxDifference>(linear, strategy);
+        };
 
-    std::cout << "RGBA" << std::endl;
+        // Banded lines are collapsed first, keys are the same as Approximate's
+        if (options.multiresolution == 0)
+            return fit_with(Gradient::Strategy::Collapsed<Gradient::Strategy::Approximate>{});
+        return fit_with(Gradient::Strategy::Collapsed<Gradient::Strategy::Multiresolution>{ .inner = { .coarse_size = options.multiresolution } });
+    }
 
-    using namespace ItG;
+    std::filesystem::path output_name(const Options& options, const std::filesystem::path& image_path) {
+        auto name = image_path.filename();
+        name += Gradient::Format::extension(options.format);
+        return name;
+    }
+
+    void print_statistics(const Cache& cache) {
+        const auto statistics = cache.stats();
+        std::cout << "cache: " << statistics.memory_hits << " memory hits, " << statistics.disk_hits << " disk hits, "
+            << statistics.misses << " misses" << std::endl;
+    }
 
-    auto image = Image::gil::load<Image::gil::RGBA>(image_path);
-    auto view = boost::gil::view(image);
-    auto linear = Image::gil::get_linear< Gradient::LinearRGBA >(view, 0.0f, 0.5f, 1.0f, 0.5f);
+}
+
+using namespace ItG;
+using namespace ItG::Console;
 
-    auto gradient = Gradient::from_gradient<Gradient::Operator::MaxDifference, Gradient::Strategy::Approximate>(linear);
+void print_usage() {
+    std::cout << "Usage: image-to-gradient [--format css|svg|json|binary] [--memory-budget MiB] [--coarse pixels] [--multiresolution samples] image_path output_path\n"
+        << "       image-to-gradient [options] [--decode-threads N] [--sample-threads N] [--fit-threads N] [--serialize-threads N] [--queue-depth N] [--metrics] image_path... output_directory\n"
+        << "       image-to-gradient [options] --watch [--debounce ms] input_directory... output_directory\n"
+        << "       image-to-gradient [options] --simplify gradients.css|gradients.svg... output_path\n"
+        << "       --cache directory reuses results for identical sampled lines\n"
+        << "       --trace file.json writes Chrome trace, if built with IMAGE_TO_GRADIENT_TRACE";
+}
 
-    std::stringstream gradient_css;
-    gradient_css << "linear-gradient(90deg";
-    for (auto& key : gradient) {
-        gradient_css << ", ";
-        gradient_css << "rgba("
-            << key.color[0] * 255. << ", "
-            << key.color[1] * 255. << ", "
-            << key.color[2] * 255. << ", "
-            << key.color[3] * 100 << "%) "
-            << key.position * 100 << "%";
+/// @brief Parse whole argument as unsigned number in [min, max]
+bool parse_number(std::string_view text, size_t& value, size_t min = 0, size_t max = std::numeric_limits<size_t>::max()) {
+    size_t parsed = 0;
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), parsed);
+    if (error != std::errc{} || end != text.data() + text.size() || parsed < min || parsed > max)
+        return false;
+    value = parsed;
+    return true;
+}
+
+bool parse_options(int argc, char** argv, Options& options) {
+    // Limits keep derived sizes from overflowing: budget is converted to bytes, queue capacity is rounded up to a power of two
+    constexpr size_t max_budget = std::numeric_limits<size_t>::max() >> 20;
+    constexpr size_t max_threads = 1024;
+    constexpr size_t max_queue_depth = size_t(1) << 20;
+    constexpr size_t max_debounce = size_t(24) * 60 * 60 * 1000;
+
+    std::vector<std::string_view> positional;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        bool valid = true;
+        if (arg == "--format" && i + 1 < argc) {
+            options.format = argv[++i];
+        } else if (arg == "--memory-budget" && i + 1 < argc) {
+            valid = parse_number(argv[++i], options.memory_budget, 0, max_budget);
+        } else if (arg == "--coarse" && i + 1 < argc) {
+            valid = parse_number(argv[++i], options.coarse_size);
+        } else if (arg == "--multiresolution" && i + 1 < argc) {
+            valid = parse_number(argv[++i], options.multiresolution);
+        } else if (arg == "--decode-threads" && i + 1 < argc) {
+            valid = parse_number(argv[++i], options.decode_threads, 1, max_threads);
+        } else if (arg == "--sample-threads" && i + 1 < argc) {
+            valid = parse_number(argv[++i], options.sample_threads, 1, max_threads);
+        } else if (arg == "--fit-threads" && i + 1 < argc) {
+            valid = parse_number(argv[++i], options.fit_threads, 0, max_threads);
+        } else if (arg == "--serialize-threads" && i + 1 < argc) {
+            valid = parse_number(argv[++i], options.serialize_threads, 1, max_threads);
+        } else if (arg == "--queue-depth" && i + 1 < argc) {
+            valid = parse_number(argv[++i], options.queue_depth, 1, max_queue_depth);
+        } else if (arg == "--cache" && i + 1 < argc) {
+            options.cache_path = argv[++i];
+        } else if (arg == "--trace" && i + 1 < argc) {
+            options.trace_path = argv[++i];
+        } else if (arg == "--simplify") {
+            options.simplify = true;
+        } else if (arg == "--watch") {
+            options.watch = true;
+        } else if (arg == "--debounce" && i + 1 < argc) {
+            valid = parse_number(argv[++i], options.debounce_ms, 0, max_debounce);
+        } else if (arg == "--metrics") {
+            options.metrics = true;
+        } else if (arg.starts_with("--")) {
+            return false;
+        } else {
+            positional.push_back(arg);
+        }
+
+        if (!valid)
+            return false;
     }
-    gradient_css << ")";
 
-    std::cout << gradient_css.rdbuf() << std::endl;
+    if (positional.size() < 2)
+        return false;
+
+    options.output_path = positional.back();
+    positional.pop_back();
+    for (auto& path : positional)
+        options.image_paths.emplace_back(path);
+
+    if (options.fit_threads == 0)
+        options.fit_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    return true;
+}
+
+int run(const Options& options) {
+    std::unique_ptr<Cache> cache;
+    if (!options.cache_path.empty())
+        cache = std::make_unique<Cache>(Cache::Options{ .directory = options.cache_path });
+
+    if (options.simplify)
+        return run_simplify(options, cache.get());
+
+    if (options.watch)
+        return run_watch(options, cache.get());
+
+    if (options.image_paths.size() > 1 || std::filesystem::is_directory(options.output_path))
+        return run_batch(options, cache.get());
+
+    std::cout << "RGBA" << std::endl;
+
+    auto linear = sample(options, options.image_paths.front());
+    if (linear.empty()) {
+        std::cout << "Failed to process " << options.image_paths.front().string() << std::endl;
+        return 1;
+    }
+
+    auto gradient = fit(options, linear, cache.get());
+
+    std::vector<char> buffer;
+    const std::string_view result = Gradient::Format::to_named(options.format, gradient, buffer);
+    if (result.empty()) {
+        std::cout << "Failed to format gradient" << std::endl;
+        return 1;
+    }
+
+    std::ofstream output_file(options.output_path, std::ios::binary);
+    output_file.write(result.data(), result.size());
+
+    if (options.format != "binary")
+        std::cout << result << std::endl;
 
     return 0;
 }
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage();
+        return 1;
+    }
+
+    if (Gradient::Format::extension(options.format).empty()) {
+        std::cout << "Unknown output format: " << options.format << std::endl;
+        return 1;
+    }
+
+    ITG_TRACE_THREAD("main");
+
+    const int result = run(options);
+
+    if (!options.trace_path.empty() && !Trace::save(options.trace_path))
+        std::cout << "Failed to write trace " << options.trace_path.string() << std::endl;
+
+    return result;
+}
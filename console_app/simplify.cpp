@@ -0,0 +1,63 @@
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#include "app.hpp"
+#include "gradient/format/parse.hpp"
+
+namespace ItG::Console {
+
+    int run_simplify(const Options& options, Cache* cache) {
+        std::ofstream output_file(options.output_path, std::ios::binary);
+        if (!output_file) {
+            std::cout << "Failed to open " << options.output_path.string() << std::endl;
+            return 1;
+        }
+
+        Gradient::LinearRGBA parsed;
+        std::vector<char> buffer;
+        size_t count = 0;
+        size_t keys_before = 0;
+        size_t keys_after = 0;
+        size_t errors = 0;
+
+        for (const auto& input_path : options.image_paths) {
+            std::ifstream input(input_path, std::ios::binary);
+            if (!input) {
+                std::cout << "Failed to read " << input_path.string() << std::endl;
+                errors++;
+                continue;
+            }
+            const std::string text{ std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>() };
+
+            const auto syntax = input_path.extension() == ".svg" ? Gradient::Format::Syntax::SVG : Gradient::Format::Syntax::CSS;
+            Gradient::Format::GradientReader reader(text, syntax);
+            while (reader.next(parsed)) {
+                keys_before += parsed.size();
+
+                const auto gradient = fit(options, parsed, cache);
+                const std::string_view result = Gradient::Format::to_named(options.format, gradient, buffer);
+                if (result.empty()) {
+                    errors++;
+                    continue;
+                }
+
+                output_file.write(result.data(), result.size());
+                if (options.format != "binary")
+                    output_file.put('\n');
+
+                keys_after += gradient.size();
+                count++;
+            }
+            errors += reader.errors();
+        }
+
+        std::cout << count << " gradients simplified, " << keys_before << " keys to " << keys_after;
+        if (errors > 0)
+            std::cout << ", " << errors << " skipped";
+        std::cout << std::endl;
+
+        return errors > 0 ? 1 : 0;
+    }
+
+}
@@ -0,0 +1,297 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <csignal>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+
+#ifdef __linux__
+#include <cerrno>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "app.hpp"
+
+namespace ItG::Console {
+
+    namespace {
+
+        namespace fs = std::filesystem;
+
+        /// @brief Content hash by input path
+        using State = std::map<fs::path, std::string>;
+
+        volatile std::sig_atomic_t interrupted = 0;
+
+        bool is_image(const fs::path& path) {
+            std::string extension = path.extension().string();
+            std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            return extension == ".png" || extension == ".jpg" || extension == ".jpeg";
+        }
+
+        fs::path output_file(const Options& options, const fs::path& image_path) {
+            return options.output_path / output_name(options, image_path);
+        }
+
+        /// @brief Other known input writing the same output file, empty if the output is free
+        fs::path output_owner(const Options& options, const State& state, const fs::path& image_path) {
+            const auto output = output_file(options, image_path);
+            for (const auto& [path, hash] : state) {
+                if (path != image_path && output_file(options, path) == output)
+                    return path;
+            }
+            return {};
+        }
+
+        fs::path state_file(const Options& options) {
+            return options.output_path / ".itg-watch";
+        }
+
+        /// @brief Hash of file contents and of options that change output
+        /// @return Empty if file can't be read
+        std::string content_hash(const Options& options, const fs::path& path) {
+            std::ifstream input(path, std::ios::binary);
+            if (!input)
+                return {};
+
+            Gradient::Hasher hasher;
+            hasher.add(options.format);
+            hasher.add(uint64_t(options.coarse_size));
+            hasher.add(uint64_t(options.memory_budget > 0));
+            hasher.add(uint64_t(options.multiresolution));
+
+            std::vector<char> buffer(size_t(1) << 20);
+            uint64_t total = 0;
+            while (input) {
+                input.read(buffer.data(), buffer.size());
+                const size_t read = static_cast<size_t>(input.gcount());
+                const size_t words = (read + 7) / 8;
+                // Zero tail of the last word
+                std::fill(buffer.begin() + read, buffer.begin() + words * 8, char(0));
+                for (size_t i = 0; i < words; i++) {
+                    uint64_t word;
+                    std::memcpy(&word, buffer.data() + 8 * i, sizeof(word));
+                    hasher.add(word);
+                }
+                total += read;
+            }
+            hasher.add(total);
+
+            return hasher.digest().to_string();
+        }
+
+        /// @brief Replace file so readers see either old or new content
+        bool write_atomic(const fs::path& path, std::string_view content) {
+            auto temporary = path;
+            temporary += ".tmp";
+            {
+                std::ofstream output(temporary, std::ios::binary);
+                output.write(content.data(), content.size());
+                if (!output)
+                    return false;
+            }
+
+            std::error_code error;
+            fs::rename(temporary, path, error);
+            if (error) {
+                fs::remove(temporary, error);
+                return false;
+            }
+            return true;
+        }
+
+        /// @brief State file has one "hash path" line per processed input
+        State load_state(const Options& options) {
+            State state;
+            std::ifstream input(state_file(options), std::ios::binary);
+            std::string line;
+            while (std::getline(input, line)) {
+                const size_t separator = line.find(' ');
+                if (separator == line.npos)
+                    continue;
+                state.emplace(fs::path(std::u8string(line.begin() + separator + 1, line.end())), line.substr(0, separator));
+            }
+            return state;
+        }
+
+        bool save_state(const Options& options, const State& state) {
+            std::string content;
+            for (const auto& [path, hash] : state) {
+                const auto utf8 = path.u8string();
+                content += hash;
+                content += ' ';
+                content.append(utf8.begin(), utf8.end());
+                content += '\n';
+            }
+            return write_atomic(state_file(options), content);
+        }
+
+        /// @brief Sample, fit and write output of one image
+        bool process(const Options& options, Cache* cache, const fs::path& image_path, std::vector<char>& buffer) {
+            auto linear = sample(options, image_path);
+            if (linear.empty())
+                return false;
+
+            const auto gradient = fit(options, linear, cache);
+            const std::string_view result = Gradient::Format::to_named(options.format, gradient, buffer);
+            return !result.empty() && write_atomic(output_file(options, image_path), result);
+        }
+
+        /// @brief Refit changed images, remove outputs of deleted ones
+        /// @return Number of failed images
+        size_t update(const Options& options, Cache* cache, const std::set<fs::path>& paths, State& state) {
+            std::vector<char> buffer;
+            size_t failed = 0;
+            bool changed = false;
+
+            for (const auto& image_path : paths) {
+                const std::string hash = content_hash(options, image_path);
+
+                if (hash.empty()) {
+                    if (state.erase(image_path) > 0) {
+                        // State written before outputs had owners may list several inputs of one output
+                        std::error_code error;
+                        if (output_owner(options, state, image_path).empty())
+                            fs::remove(output_file(options, image_path), error);
+                        std::cout << "Removed " << image_path.string() << std::endl;
+                        changed = true;
+                    }
+                    continue;
+                }
+
+                auto found = state.find(image_path);
+                if (found != state.end() && found->second == hash && fs::exists(output_file(options, image_path)))
+                    continue;
+
+                // Same file name in another watched directory, first processed image keeps the output
+                const fs::path owner = output_owner(options, state, image_path);
+                if (!owner.empty()) {
+                    std::cout << "Failed to process " << image_path.string() << ", output " << output_file(options, image_path).string()
+                        << " belongs to " << owner.string() << std::endl;
+                    failed++;
+                    continue;
+                }
+
+                if (!process(options, cache, image_path, buffer)) {
+                    // Image may still be written, next write triggers another attempt
+                    std::cout << "Failed to process " << image_path.string() << std::endl;
+                    failed++;
+                    continue;
+                }
+
+                state[image_path] = hash;
+                changed = true;
+                std::cout << "Updated " << image_path.string() << std::endl;
+            }
+
+            if (changed && !save_state(options, state))
+                std::cout << "Failed to write state " << state_file(options).string() << std::endl;
+
+            return failed;
+        }
+
+        /// @brief Images in watched directories and inputs known from state
+        std::set<fs::path> scan(const Options& options, const State& state) {
+            std::set<fs::path> paths;
+            for (const auto& directory : options.image_paths) {
+                std::error_code error;
+                for (const auto& entry : fs::directory_iterator(directory, error)) {
+                    if (entry.is_regular_file() && is_image(entry.path()))
+                        paths.insert(fs::absolute(entry.path()));
+                }
+            }
+            for (const auto& [path, hash] : state)
+                paths.insert(path);
+            return paths;
+        }
+
+    }
+
+    int run_watch(const Options& options, Cache* cache) {
+        std::filesystem::create_directories(options.output_path);
+
+        State state = load_state(options);
+        update(options, cache, scan(options, state), state);
+
+#ifdef __linux__
+        using Clock = std::chrono::steady_clock;
+
+        const int inotify = inotify_init1(IN_CLOEXEC);
+        if (inotify < 0) {
+            std::cout << "Failed to initialize inotify" << std::endl;
+            return 1;
+        }
+
+        std::map<int, fs::path> directories;
+        for (const auto& directory : options.image_paths) {
+            const int watch = inotify_add_watch(inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE);
+            if (watch < 0) {
+                std::cout << "Failed to watch " << directory.string() << std::endl;
+                close(inotify);
+                return 1;
+            }
+            directories.emplace(watch, fs::absolute(directory));
+        }
+
+        std::signal(SIGINT, [](int) { interrupted = 1; });
+        std::signal(SIGTERM, [](int) { interrupted = 1; });
+
+        std::cout << "Watching " << directories.size() << " directories" << std::endl;
+
+        std::set<fs::path> pending;
+        Clock::time_point deadline{};
+        alignas(inotify_event) char events[64 * (sizeof(inotify_event) + NAME_MAX + 1)];
+
+        while (!interrupted) {
+            // Sleep until next event, or until burst of events ends
+            int timeout = -1;
+            if (!pending.empty())
+                timeout = static_cast<int>(std::max<int64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count(), 0));
+
+            pollfd descriptor{ inotify, POLLIN, 0 };
+            const int ready = poll(&descriptor, 1, timeout);
+            if (ready < 0) {
+                if (errno == EINTR)
+                    continue;
+                break;
+            }
+
+            if (ready == 0) {
+                update(options, cache, pending, state);
+                pending.clear();
+                continue;
+            }
+
+            const ssize_t length = read(inotify, events, sizeof(events));
+            for (ssize_t offset = 0; offset < length;) {
+                const auto* event = reinterpret_cast<const inotify_event*>(events + offset);
+                offset += sizeof(inotify_event) + event->len;
+
+                if (event->mask & IN_Q_OVERFLOW) {
+                    const auto all = scan(options, state);
+                    pending.insert(all.begin(), all.end());
+                } else if (event->len > 0) {
+                    const fs::path path = directories[event->wd] / event->name;
+                    if (is_image(path))
+                        pending.insert(path);
+                }
+            }
+            deadline = Clock::now() + std::chrono::milliseconds(options.debounce_ms);
+        }
+
+        close(inotify);
+        if (!pending.empty())
+            update(options, cache, pending, state);
+        return 0;
+#else
+        std::cout << "Watching directories requires inotify, only the initial update was done" << std::endl;
+        return 1;
+#endif
+    }
+
+}
@@ -2,10 +2,22 @@
 
 #include <QApplication>
 
+#include <cstdlib>
+
+#include "trace/trace.hpp"
+
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
     MainWindow w;
     w.show();
-    return a.exec();
+
+    ITG_TRACE_THREAD("ui");
+    const int result = a.exec();
+
+    // Chrome trace of the session, if built with IMAGE_TO_GRADIENT_TRACE
+    if (const char* trace_path = std::getenv("ITG_TRACE_FILE"))
+        ItG::Trace::save(trace_path);
+
+    return result;
 }
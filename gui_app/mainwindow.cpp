@@ -6,6 +6,7 @@
 
 #include "gradient.hpp"
 #include "image/qt_image.hpp"
+#include "trace/trace.hpp"
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent), ui(new Ui::MainWindow)
@@ -29,6 +30,10 @@ MainWindow::MainWindow(QWidget *parent)
     gradientScene = new QGraphicsScene(this);
     ui->gradientView->setScene(gradientScene);
 
+    refineTimer = new QTimer(this);
+    refineTimer->setSingleShot(true);
+    refineTimer->setInterval(150);
+    connect(refineTimer, &QTimer::timeout, this, &MainWindow::updateGradient);
 }
 
 MainWindow::~MainWindow()
@@ -64,6 +69,11 @@ void MainWindow::on_startY_valueChanged(double d) { updateSamplePoints(); }
 void MainWindow::on_endX_valueChanged(double d) { updateSamplePoints(); }
 void MainWindow::on_endY_valueChanged(double d) { updateSamplePoints(); }
 
+void MainWindow::on_startX_editingFinished() { if (refineTimer->isActive()) updateGradient(); }
+void MainWindow::on_startY_editingFinished() { if (refineTimer->isActive()) updateGradient(); }
+void MainWindow::on_endX_editingFinished() { if (refineTimer->isActive()) updateGradient(); }
+void MainWindow::on_endY_editingFinished() { if (refineTimer->isActive()) updateGradient(); }
+
 void MainWindow::on_deflectionByte_valueChanged(double d) { ui->deflectionFloat->setValue(d / 255.f); };
 void MainWindow::on_deflectionFloat_valueChanged(double d) { updateGradient(); }
 
@@ -78,13 +88,16 @@ void MainWindow::setImage(const QString& path) {
     if (path == ui->imagePath->text() || path.isEmpty() || !QFileInfo::exists(path))
         return;
 
+    ITG_TRACE_ZONE("setImage");
+
     QPixmap pixmap{ path };
     if (pixmap.isNull())
         return;
 
     ui->imagePath->setText(path);
 
-    currentImage = pixmap.toImage();
+    currentImage = ItG::Image::Qt::prepare(pixmap.toImage());
+    pyramid = ItG::Image::Qt::build_pyramid(currentImage);
 
     if (currentPixmap) {
         currentPixmap->setPixmap(pixmap);
@@ -99,13 +112,20 @@ void MainWindow::setImage(const QString& path) {
     }
     // todo update inputScene size/transform
 
-    updateSamplePoints();
+    // Full resolution fit only, a preview would be replaced right away
+    updateSampler();
+    updateGradient();
 }
 
 void MainWindow::updateSamplePoints() {
     if (currentImage.isNull())
         return;
 
+    updateSampler();
+    previewGradient();
+}
+
+void MainWindow::updateSampler() {
     float start_x = ui->startX->value();
     float start_y = ui->startY->value();
     float end_x = ui->endX->value();
@@ -124,14 +144,39 @@ void MainWindow::updateSamplePoints() {
 
     samplerEnd->setBrush( ItG::Image::Qt::get_color(currentImage, end_x, end_y) );
     samplerEnd->setRect(x2 - dot_r, y2 - dot_r, 2 * dot_r, 2 * dot_r);
-
-    updateGradient();
 }
 
 void MainWindow::updateGradient() {
     if (currentImage.isNull())
         return;
 
+    ITG_TRACE_ZONE("updateGradient");
+
+    refineTimer->stop();
+    showGradient(currentImage);
+}
+
+void MainWindow::previewGradient() {
+    if (currentImage.isNull())
+        return;
+
+    ITG_TRACE_ZONE("previewGradient");
+
+    // Sample level with about one pixel per displayed pixel of the line
+    QLineF line{ samplerLine->mapToScene(samplerLine->line().p1()), samplerLine->mapToScene(samplerLine->line().p2()) };
+    QLineF displayed{ ui->imageView->mapFromScene(line.p1()), ui->imageView->mapFromScene(line.p2()) };
+
+    const QImage& level = ItG::Image::Qt::select_level(pyramid,
+        ui->startX->value(), ui->startY->value(), ui->endX->value(), ui->endY->value(), displayed.length());
+    showGradient(level);
+
+    if (&level != &pyramid.front())
+        refineTimer->start();
+    else
+        refineTimer->stop();
+}
+
+void MainWindow::showGradient(const QImage& source) {
     float start_x = ui->startX->value();
     float start_y = ui->startY->value();
     float end_x = ui->endX->value();
@@ -146,7 +191,7 @@ void MainWindow::updateGradient() {
 
     // TODO store
     using namespace ItG::Gradient;
-    LinearRGBA linear = ItG::Image::Qt::get_linear(currentImage, start_x, start_y, end_x, end_y);
+    LinearRGBA linear = ItG::Image::Qt::get_linear(source, start_x, start_y, end_x, end_y);
 
     LinearRGBA gradient{};
     if (ui->modeApproximate->isChecked()) {
@@ -170,7 +215,6 @@ void MainWindow::updateGradient() {
 
     gradientScene->clear();
     QLinearGradient qt_gradient(0, 0, ui->gradientView->contentsRect().width(), 0);
-    QStringList stops;
     qt_gradient.setSpread(QGradient::PadSpread);
     QRectF total_rect = gradientScene->sceneRect();
     qreal dot_half_size = 3;
@@ -182,11 +226,6 @@ void MainWindow::updateGradient() {
             std::clamp(static_cast<int>(stop.color[3] * 255), 0, 255) 
         };
         qt_gradient.setColorAt(stop.position, color);
-        stops.push_back(
-            QString("rgba(%1, %2, %3, %4) %5%")
-            .arg( color.red() ).arg( color.green() ).arg( color.blue() ).arg( color.alpha() )
-            .arg(stop.position * 100.f)
-        );
 
         QGraphicsEllipseItem* stopDot = new QGraphicsEllipseItem( 
             std::lerp(stops_x1, stops_x2, stop.position) - dot_radius,
@@ -199,6 +238,8 @@ void MainWindow::updateGradient() {
     gradientScene->setSceneRect(ui->gradientView->contentsRect());
     gradientScene->addRect(ui->gradientView->contentsRect(), {}, qt_gradient);
 
-    ui->gradientStops->setPlainText(stops.join(", "));
+    cssBuffer.resize(std::max(cssBuffer.size(), Format::css_capacity(gradient)));
+    auto css = Format::to_css(cssBuffer, gradient);
+    ui->gradientStops->setPlainText(QString::fromUtf8(cssBuffer.data(), css.ptr - cssBuffer.data()));
 }
 
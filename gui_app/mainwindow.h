@@ -9,6 +9,9 @@
 #include <QGraphicsItemGroup>
 #include <QDragEnterEvent>
 #include <QDropEvent>
+#include <QTimer>
+
+#include <vector>
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -31,6 +34,11 @@ private slots:
     void on_endX_valueChanged(double d);
     void on_endY_valueChanged(double d);
 
+    void on_startX_editingFinished();
+    void on_startY_editingFinished();
+    void on_endX_editingFinished();
+    void on_endY_editingFinished();
+
     void on_deflectionFloat_valueChanged(double d);
     void on_deflectionByte_valueChanged(double d);
 
@@ -43,8 +51,13 @@ private slots:
     void setImage(const QString& path);
     void updateSamplePoints();
     void updateGradient();
+    void previewGradient();
 
 private:
+    /// @brief Move sampler line and end points to current coordinates
+    void updateSampler();
+    void showGradient(const QImage& source);
+
     void dragEnterEvent(QDragEnterEvent* event);
     void dropEvent(QDropEvent* event);
 
@@ -52,6 +65,10 @@ private:
     Ui::MainWindow *ui;
 
     QImage currentImage;
+    /// Halvings of currentImage, sampled while sample points change
+    std::vector<QImage> pyramid;
+    /// Recomputes gradient at full resolution once sample points stop changing
+    QTimer* refineTimer = nullptr;
 
     QGraphicsScene* inputScene;
     QGraphicsItemGroup* inputRoot = nullptr;
@@ -63,5 +80,7 @@ private:
 
     QGraphicsScene* gradientScene;
 
+    std::vector<char> cssBuffer;
+
 };
 #endif // MAINWINDOW_H
@@ -3,6 +3,22 @@
 #include "gradient/color.hpp"
 #include "gradient/linear.hpp"
 #include "gradient/builder.hpp"
+#include "gradient/evaluate.hpp"
+#include "gradient/cache.hpp"
+#include "gradient/batch.hpp"
+#include "gradient/sequence.hpp"
+#include "gradient/refine.hpp"
 #include "gradient/strategy/approximate.hpp"
+#include "gradient/strategy/anytime.hpp"
+#include "gradient/strategy/multiresolution.hpp"
+#include "gradient/strategy/collapse.hpp"
 #include "gradient/strategy/step_count.hpp"
+#include "gradient/strategy/auto.hpp"
+#include "gradient/strategy/streaming.hpp"
 #include "gradient/operator/max_difference.hpp"
+#include "gradient/format/css.hpp"
+#include "gradient/format/svg.hpp"
+#include "gradient/format/json.hpp"
+#include "gradient/format/binary.hpp"
+#include "gradient/format/named.hpp"
+#include "gradient/format/parse.hpp"
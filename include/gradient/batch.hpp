@@ -0,0 +1,388 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "gradient/linear.hpp"
+#include "gradient/builder.hpp"
+#include "gradient/evaluate.hpp"
+#include "gradient/operator/max_difference.hpp"
+#include "gradient/strategy/approximate.hpp"
+
+namespace ItG::Gradient {
+
+    namespace Detail {
+
+        /// @brief condition ? a : b on bits, no branch for compiler to keep
+        inline float select(bool condition, float a, float b) {
+            const uint32_t mask = 0u - uint32_t(condition);
+            return std::bit_cast<float>((std::bit_cast<uint32_t>(a) & mask) | (std::bit_cast<uint32_t>(b) & ~mask));
+        }
+
+        /// @brief std::lerp without branches, same result for finite arguments.
+        /// Both results are computed and selected, so loops over lanes vectorize.
+        inline float lerp(float a, float b, float t) {
+            const bool opposite = ((a <= 0.f) & (b >= 0.f)) | ((a >= 0.f) & (b <= 0.f));
+            const float exact = t * b + (1.f - t) * a;
+            const float x = a + t * (b - a);
+            const float monotonic = select((t > 1.f) == (b > a), select(b < x, x, b), select(x < b, x, b));
+            return select(opposite, exact, select(t == 1.f, b, monotonic));
+        }
+
+    }
+
+    /// @brief Approximate strategy with MaxDifference operator over many independent gradients.
+    /// Gradients are processed Lanes at a time, interleaved sample by sample (AoSoA), so a sweep evaluates
+    /// the same sample of all lanes with the same instructions and lanes stay in vector registers.
+    /// Each sweep splits every pending section of every lane at its farthest key, breadth-first instead of depth-first.
+    /// A split depends only on its section, so extracted keys are the same as with Approximate.
+    /// Lanes without a section at the current sample are masked, finished lanes stay masked until the group ends.
+    /// Gradients are grouped by length, so lanes of a group end at similar samples.
+    /// Lockstep sweeps pay per section boundary and only gain over long sections: a lane whose pending sections get shorter than
+    /// min_section samples on average splits them one by one on its own gradient, as Approximate does. So do all lanes of a group
+    /// whose lengths differ more than twice, or once fewer than half of the lanes are left for lockstep.
+    /// Buffers are reused between calls, not thread safe.
+    /// @tparam TGradient Gradient type
+    /// @tparam Lanes Number of gradients processed together
+    template<LinearData TGradient, size_t Lanes = 8>
+    class ApproximateBatch {
+    public:
+        static constexpr size_t lane_count = Lanes;
+
+        /// @brief Keys farther than tolerance are split, as Strategy::Approximate::tolerance
+        float tolerance;
+        /// @brief Average pending section length per lane below which sections are split one by one
+        size_t min_section = 8 * Lanes;
+
+        explicit ApproximateBatch(Strategy::Approximate strategy = {}) : tolerance(strategy.tolerance) {}
+
+        /// @brief Extract keys of every gradient, outputs[i] receives the same keys as from_gradient_into(gradients[i], outputs[i], builder)
+        /// @param gradients Input gradients
+        /// @param outputs Output gradients, at least as many as gradients. Previous content is replaced, capacity is reused.
+        /// @param builder Output range
+        void operator()(std::span<const TGradient> gradients, std::span<TGradient> outputs, const Builder<TGradient>& builder = {}) {
+            ITG_TRACE_ZONE("ApproximateBatch");
+
+            order.resize(gradients.size());
+            for (size_t i = 0; i < order.size(); i++)
+                order[i] = i;
+            std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return std::size(gradients[a]) < std::size(gradients[b]); });
+
+            for (size_t first = 0; first < gradients.size(); first += Lanes) {
+                const size_t count = std::min(Lanes, gradients.size() - first);
+                const std::span<const size_t> group(order.data() + first, count);
+                fit(gradients, group);
+
+                for (size_t l = 0; l < count; l++)
+                    build(gradients[group[l]], lanes[l], outputs[group[l]], builder);
+            }
+        }
+
+    private:
+        static constexpr size_t Size = LinearRange_Value<TGradient>::size;
+        static constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+
+        /// @brief Indices of first and last key of a section, shared with neighbouring sections
+        struct Section {
+            uint32_t first;
+            uint32_t last;
+        };
+
+        struct Lane {
+            /// Sections to split in current sweep, in order
+            std::vector<Section> pending;
+            /// Sections to split in next sweep
+            std::vector<Section> next;
+            /// Extracted key indices
+            std::vector<uint32_t> splits;
+            /// Index of current section in pending
+            size_t section = 0;
+        };
+
+        /// @brief Copy group into interleaved buffers and split until all sections are close enough
+        /// @param group Indices of gradients in lanes, sorted by length
+        void fit(std::span<const TGradient> gradients, std::span<const size_t> group) {
+            const size_t length = std::size(gradients[group.back()]);
+
+            for (size_t l = 0; l < Lanes; l++) {
+                Lane& lane = lanes[l];
+                lane.pending.clear();
+                lane.splits.clear();
+
+                // Sections with less than 3 keys have no key to split at
+                if (l < group.size() && std::size(gradients[group[l]]) >= 3)
+                    lane.pending.push_back({ 0, static_cast<uint32_t>(std::size(gradients[group[l]]) - 1) });
+            }
+
+            // Missing and short lanes would idle masked for most of every sweep
+            if (2 * group.size() < Lanes || 2 * std::size(gradients[group.front()]) < length) {
+                for (size_t l = 0; l < group.size(); l++)
+                    split_each(gradients[group[l]], l);
+                return;
+            }
+
+            positions.assign(length * Lanes, 0.f);
+            colors.assign(length * Size * Lanes, 0.f);
+
+            for (size_t l = 0; l < group.size(); l++) {
+                size_t i = 0;
+                for (const auto& key : gradients[group[l]]) {
+                    positions[i * Lanes + l] = key.position;
+                    for (size_t c = 0; c < Size; c++)
+                        colors[(i * Size + c) * Lanes + l] = Detail::channel(key.color, c);
+                    i++;
+                }
+            }
+
+            for (;;) {
+                size_t busy = 0;
+                for (size_t l = 0; l < group.size(); l++) {
+                    Lane& lane = lanes[l];
+                    if (lane.pending.empty())
+                        continue;
+
+                    size_t samples = 0;
+                    for (const Section& section : lane.pending)
+                        samples += section.last - section.first;
+
+                    if (samples < min_section * lane.pending.size())
+                        split_each(gradients[group[l]], l);
+                    else
+                        busy++;
+                }
+                if (busy == 0)
+                    break;
+
+                // Masked lanes cost as much as busy ones
+                if (2 * busy < Lanes) {
+                    for (size_t l = 0; l < group.size(); l++)
+                        split_each(gradients[group[l]], l);
+                    break;
+                }
+
+                sweep();
+
+                for (Lane& lane : lanes) {
+                    std::swap(lane.pending, lane.next);
+                    lane.next.clear();
+                }
+            }
+        }
+
+        /// @brief Find farthest key of every pending section in one pass over samples
+        void sweep() {
+            for (size_t l = 0; l < Lanes; l++) {
+                lanes[l].section = 0;
+                active[l] = 0;
+                event[l] = lanes[l].pending.empty() ? none : lanes[l].pending.front().first;
+            }
+
+            uint32_t i = 0;
+            for (;;) {
+                const uint32_t stop = *std::min_element(event.begin(), event.end());
+                if (stop == none)
+                    break;
+
+                // No section starts or ends before stop, all lanes run the same code.
+                // Local copies can't alias samples, so compilers vectorize without runtime checks.
+                alignas(64) std::array<float, Lanes> best_value = best;
+                alignas(64) std::array<uint32_t, Lanes> best_index = farthest;
+                for (; i < stop; i++) {
+                    const float* position = positions.data() + i * Lanes;
+                    const float* color = colors.data() + i * Size * Lanes;
+
+                    alignas(64) std::array<float, Lanes> t;
+                    for (size_t l = 0; l < Lanes; l++)
+                        t[l] = (position[l] - first_position[l]) * scale[l];
+
+                    alignas(64) std::array<float, Lanes> value;
+                    for (size_t l = 0; l < Lanes; l++)
+                        value[l] = std::abs(color[l] - Detail::lerp(first_color[0][l], last_color[0][l], t[l]));
+
+                    for (size_t c = 1; c < Size; c++) {
+                        color += Lanes;
+                        for (size_t l = 0; l < Lanes; l++) {
+                            const float difference = std::abs(color[l] - Detail::lerp(first_color[c][l], last_color[c][l], t[l]));
+                            value[l] = Detail::select(value[l] < difference, difference, value[l]);
+                        }
+                    }
+
+                    for (size_t l = 0; l < Lanes; l++) {
+                        const bool better = (active[l] != 0) & (best_value[l] < value[l]);
+                        best_value[l] = Detail::select(better, value[l], best_value[l]);
+                        best_index[l] = better ? i : best_index[l];
+                    }
+                }
+                best = best_value;
+                farthest = best_index;
+
+                for (size_t l = 0; l < Lanes; l++) {
+                    if (event[l] != stop) {
+                        if (active[l])
+                            update(l, stop);
+                        continue;
+                    }
+
+                    if (active[l]) {
+                        update(l, stop);
+                        finish(l);
+                        lanes[l].section++;
+                    }
+
+                    begin(l, stop);
+                }
+                i = stop + 1;
+            }
+        }
+
+        /// @brief Split pending sections of lane l and their parts one at a time, depth-first on the gradient itself as Approximate does
+        void split_each(const TGradient& gradient, size_t l) {
+            using Range = std::ranges::subrange<typename TGradient::const_iterator>;
+            const Strategy::FindFarthest<Range> find_farthest;
+
+            Lane& lane = lanes[l];
+            while (!lane.pending.empty()) {
+                const Section section = lane.pending.back();
+                lane.pending.pop_back();
+
+                const auto keys = std::begin(gradient);
+                const auto [key, value] = find_farthest(Range(keys + section.first, keys + section.last + 1), Operator::MaxDifference{});
+                farthest[l] = static_cast<uint32_t>(key - keys);
+                best[l] = value;
+                split(l, section, lane.pending);
+            }
+        }
+
+        /// @brief Distance of key i of lane l to interpolation between ends of its current section, as MaxDifference
+        float distance(uint32_t i, size_t l) const {
+            const float t = (positions[i * Lanes + l] - first_position[l]) * scale[l];
+            const float* color = colors.data() + i * Size * Lanes;
+
+            float result = std::abs(color[l] - Detail::lerp(first_color[0][l], last_color[0][l], t));
+            for (size_t c = 1; c < Size; c++) {
+                const float difference = std::abs(color[c * Lanes + l] - Detail::lerp(first_color[c][l], last_color[c][l], t));
+                result = Detail::select(result < difference, difference, result);
+            }
+            return result;
+        }
+
+        void update(size_t l, uint32_t i) {
+            const float value = distance(i, l);
+            if (best[l] < value) {
+                best[l] = value;
+                farthest[l] = i;
+            }
+        }
+
+        /// @brief Start next section of lane l if it begins at i, otherwise wait for its beginning
+        void begin(size_t l, uint32_t i) {
+            Lane& lane = lanes[l];
+            active[l] = 0;
+
+            if (lane.section >= lane.pending.size()) {
+                event[l] = none;
+                return;
+            }
+
+            const Section section = lane.pending[lane.section];
+            if (section.first != i) {
+                event[l] = section.first;
+                return;
+            }
+
+            start(l, section);
+            active[l] = 1;
+            event[l] = section.last;
+        }
+
+        /// @brief Set section of lane l as current, its first key is the farthest so far
+        void start(size_t l, const Section& section) {
+            const float first = positions[section.first * Lanes + l];
+            const float last = positions[section.last * Lanes + l];
+            first_position[l] = first;
+            scale[l] = 1.f / (last - first);
+            for (size_t c = 0; c < Size; c++) {
+                first_color[c][l] = colors[(section.first * Size + c) * Lanes + l];
+                last_color[c][l] = colors[(section.last * Size + c) * Lanes + l];
+            }
+
+            best[l] = distance(section.first, l);
+            farthest[l] = section.first;
+        }
+
+        /// @brief Split current section of lane l as Approximate does
+        void finish(size_t l) {
+            Lane& lane = lanes[l];
+            split(l, lane.pending[lane.section], lane.next);
+        }
+
+        /// @brief Split section of lane l at its farthest key if it's farther than tolerance, parts with inner keys are added to parts
+        void split(size_t l, const Section& section, std::vector<Section>& parts) {
+            const uint32_t key = farthest[l];
+            if (key == section.first || key == section.last || best[l] <= tolerance)
+                return;
+
+            lanes[l].splits.push_back(key);
+            if (key - section.first >= 2)
+                parts.push_back({ section.first, key });
+            if (section.last - key >= 2)
+                parts.push_back({ key, section.last });
+        }
+
+        void build(const TGradient& gradient, Lane& lane, TGradient& output, const Builder<TGradient>& builder) const {
+            output.clear();
+            if (std::empty(gradient))
+                return;
+
+            std::sort(lane.splits.begin(), lane.splits.end());
+
+            output.push_back(gradient.front());
+            for (uint32_t split : lane.splits)
+                output.emplace_back(gradient[split]);
+            output.push_back(gradient.back());
+
+            builder.transform(output);
+        }
+
+        /// Key positions, [key][lane]
+        std::vector<float> positions;
+        /// Key colors, [key][channel][lane]
+        std::vector<float> colors;
+        std::array<Lane, Lanes> lanes;
+        /// Gradient indices sorted by length
+        std::vector<size_t> order;
+
+        // Current section of each lane
+        alignas(64) std::array<float, Lanes> first_position{};
+        alignas(64) std::array<float, Lanes> scale{};
+        alignas(64) std::array<std::array<float, Lanes>, Size> first_color{};
+        alignas(64) std::array<std::array<float, Lanes>, Size> last_color{};
+        alignas(64) std::array<float, Lanes> best{};
+        std::array<uint32_t, Lanes> farthest{};
+        /// Nonzero if lane has a section at current sample
+        std::array<uint32_t, Lanes> active{};
+        /// Index of next section beginning or end
+        std::array<uint32_t, Lanes> event{};
+    };
+
+    /// @brief Extract many gradients into reusable outputs, outputs[i] receives the same keys as from_gradient_into(gradients[i], outputs[i], builder, strategy).
+    /// Approximate with MaxDifference runs gradients in lockstep lanes (ApproximateBatch), other strategies run gradients one by one.
+    template<typename DistanceOp, typename Strategy, LinearData TGradient>
+    inline void from_gradients(std::span<TGradient> gradients, std::span<TGradient> outputs, const Builder<TGradient>& builder = {}, Strategy&& strategy = {}) {
+        if constexpr (std::same_as<DistanceOp, Operator::MaxDifference> && std::same_as<std::remove_cvref_t<Strategy>, Gradient::Strategy::Approximate>) {
+            ApproximateBatch<TGradient> batch(strategy);
+            batch(gradients, outputs, builder);
+        } else {
+            for (size_t i = 0; i < gradients.size(); i++)
+                from_gradient_into<DistanceOp>(gradients[i], outputs[i], builder, strategy);
+        }
+    }
+
+}
@@ -1,46 +1,89 @@
 ﻿#pragma once
 
 #include <list>
+#include <memory>
 #include <span>
 #include <ranges>
 
 #include "linear.hpp"
+#include "trace/trace.hpp"
 
 namespace ItG::Gradient {
 
+    /// @brief Output adapter writing keys into caller owned storage.
+    /// Keys past capacity are dropped and overflow is set.
+    /// @tparam TKey Key type
+    template<IsKey TKey>
+    struct SpanOutput {
+        using value_type = TKey;
+        using iterator = typename std::span<TKey>::iterator;
+
+        std::span<TKey> storage;
+        size_t count = 0;
+        bool overflow = false;
+
+        template<typename... Args>
+        void emplace_back(Args&&... args) {
+            if (count >= storage.size()) {
+                overflow = true;
+                return;
+            }
+            // Keys are not assignable, replace in place
+            TKey* slot = &storage[count++];
+            std::destroy_at(slot);
+            std::construct_at(slot, std::forward<Args>(args)...);
+        }
+
+        void push_back(const TKey& key) { emplace_back(key); }
+
+        [[nodiscard]] size_t size() const { return count; }
+        [[nodiscard]] bool empty() const { return count == 0; }
+        [[nodiscard]] iterator begin() const { return storage.begin(); }
+        [[nodiscard]] iterator end() const { return storage.begin() + count; }
+
+        /// @brief Written keys
+        [[nodiscard]] std::span<TKey> result() const { return storage.first(count); }
+    };
+
     template<LinearData TGradient>
     struct Builder {
         using TIterator = typename TGradient::iterator;
 
         std::array<float, 2> out_range{ { 0, 1} };
 
-        void append_keys(TGradient& keys, TGradient& gradient ) const {
-            gradient.reserve(gradient.size() + keys.size());
-
+        /// @brief Map key positions from [0, 1] to out_range in place
+        void transform(std::ranges::range auto&& keys) const {
             const float offset = out_range[0];
             const float scale = (out_range[1] - out_range[0]);
-            const bool transform = out_range[0] != 0 || out_range[1] != 1;
-            
-            if (transform) {
-                std::ranges::transform(keys, back_inserter(gradient), [&](const auto& key) { return LinearRange_Value<TGradient>{key.color, key.position * scale + offset}; });
-            } else {
-                std::ranges::copy(keys, back_inserter(gradient));
-            }
+
+            if (out_range[0] == 0 && out_range[1] == 1)
+                return;
+
+            for (auto& key : keys)
+                key.position = key.position * scale + offset;
+        }
+
+        void append_keys(TGradient& keys, TGradient& gradient ) const {
+            const size_t first = gradient.size();
+            gradient.reserve(first + keys.size());
+            std::ranges::copy(keys, back_inserter(gradient));
+            transform(std::ranges::subrange(gradient.begin() + first, gradient.end()));
         }
 
-        [[nodiscard]] TGradient build(TGradient& keys ) const {
+        /// @brief Take ownership of extracted keys and transform them in place
+        [[nodiscard]] TGradient build(TGradient&& keys ) const {
             if (std::size(keys) < 1)
                 return {};
 
-            TGradient gradient;
-            append_keys(keys, gradient);
-            return gradient;
+            transform(keys);
+            return std::move(keys);
         }
     };
 
     template<typename DistanceOp, typename Strategy, LinearData TGradient>
     inline [[nodiscard]] TGradient from_gradient( TGradient& gradient, Builder<TGradient>& builder, Strategy&& strategy = {}) {
         using Iterator = Builder<TGradient>::TIterator;
+        ITG_TRACE_ZONE("from_gradient");
 
         if (gradient.empty())
             return {};
@@ -52,7 +95,50 @@ namespace ItG::Gradient {
 
         keys.push_back(gradient.back());
 
-        return builder.build(keys);
+        return builder.build(std::move(keys));
+    }
+
+    /// @brief Extract gradient into reusable caller owned vector.
+    /// Previous content of output is replaced, its capacity is kept, so repeated calls don't allocate once it's large enough.
+    template<typename DistanceOp, typename Strategy, LinearData TGradient>
+    inline void from_gradient_into( TGradient& gradient, TGradient& output, const Builder<TGradient>& builder = {}, Strategy&& strategy = {}) {
+        ITG_TRACE_ZONE("from_gradient_into");
+
+        output.clear();
+        if (gradient.empty())
+            return;
+
+        output.push_back(gradient.front());
+
+        strategy(std::ranges::subrange(gradient.begin(), gradient.end()), output, DistanceOp{});
+
+        output.push_back(gradient.back());
+
+        builder.transform(output);
+    }
+
+    /// @brief Extract gradient into caller owned span.
+    /// Capacity of max(gradient.size(), 2) keys is always sufficient, a single key gradient yields front and back.
+    /// @return Written keys, empty if gradient is empty or output is too small
+    template<typename DistanceOp, typename Strategy, LinearData TGradient>
+    inline [[nodiscard]] std::span< LinearRange_Value<TGradient> > from_gradient_into( TGradient& gradient, std::span< LinearRange_Value<TGradient> > output, const Builder<TGradient>& builder = {}, Strategy&& strategy = {}) {
+        ITG_TRACE_ZONE("from_gradient_into");
+
+        if (gradient.empty())
+            return {};
+
+        SpanOutput< LinearRange_Value<TGradient> > keys{ output };
+        keys.push_back(gradient.front());
+
+        strategy(std::ranges::subrange(gradient.begin(), gradient.end()), keys, DistanceOp{});
+
+        keys.push_back(gradient.back());
+
+        if (keys.overflow)
+            return {};
+
+        builder.transform(keys.result());
+        return keys.result();
     }
 
     template<typename DistanceOp, typename Strategy, LinearData TGradient>
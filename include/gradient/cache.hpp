@@ -0,0 +1,316 @@
+﻿#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "gradient/builder.hpp"
+#include "gradient/evaluate.hpp"
+#include "gradient/format/binary.hpp"
+#include "gradient/operator/max_difference.hpp"
+#include "gradient/strategy/approximate.hpp"
+#include "gradient/strategy/collapse.hpp"
+#include "gradient/strategy/multiresolution.hpp"
+#include "gradient/strategy/step_count.hpp"
+
+namespace ItG::Gradient {
+
+    /// @brief 128-bit content hash of a fitting request
+    struct Digest {
+        uint64_t high = 0;
+        uint64_t low = 0;
+
+        auto operator<=>(const Digest&) const = default;
+
+        /// @brief 32 hexadecimal digits
+        [[nodiscard]] std::string to_string() const {
+            constexpr std::string_view digits = "0123456789abcdef";
+            std::string result(32, '0');
+            for (size_t i = 0; i < 16; i++) {
+                result[15 - i] = digits[(high >> (4 * i)) & 0xf];
+                result[31 - i] = digits[(low >> (4 * i)) & 0xf];
+            }
+            return result;
+        }
+    };
+
+    struct DigestHash {
+        size_t operator()(const Digest& digest) const { return static_cast<size_t>(digest.low); }
+    };
+
+    /// @brief Incremental hash, two independently seeded 64-bit lanes mixed per word
+    struct Hasher {
+        uint64_t high = 0x9e3779b97f4a7c15ull;
+        uint64_t low = 0xc2b2ae3d27d4eb4full;
+
+        static uint64_t mix(uint64_t value) {
+            value ^= value >> 31;
+            value *= 0x7fb5d329728ea185ull;
+            value ^= value >> 27;
+            value *= 0x81dadef4bc2dd44dull;
+            value ^= value >> 33;
+            return value;
+        }
+
+        void add(uint64_t word) {
+            high = mix(high ^ word) + 0x9e3779b97f4a7c15ull;
+            low = mix(low + word) ^ std::rotl(high, 17);
+        }
+
+        void add(float value) { add(uint64_t(std::bit_cast<uint32_t>(value))); }
+
+        void add(std::string_view text) {
+            add(uint64_t(text.size()));
+            for (char c : text)
+                add(uint64_t(static_cast<uint8_t>(c)));
+        }
+
+        [[nodiscard]] Digest digest() const { return { mix(high), mix(low ^ high) }; }
+    };
+
+    /// @brief Strategy parameters that determine fitting result
+    /// Each strategy adds a stable tag first, type names differ between compilers and digests are shared through cache directories.
+    inline void hash_parameters(Hasher& hasher, const Strategy::Approximate& strategy) {
+        hasher.add("Approximate");
+        hasher.add(strategy.tolerance);
+    }
+    inline void hash_parameters(Hasher& hasher, const Strategy::ApproximateRecurse& strategy) {
+        hasher.add("ApproximateRecurse");
+        hasher.add(strategy.tolerance);
+    }
+    inline void hash_parameters(Hasher& hasher, const Strategy::Multiresolution& strategy) {
+        hasher.add("Multiresolution");
+        hasher.add(strategy.tolerance);
+        hasher.add(uint64_t(strategy.coarse_size));
+    }
+    inline void hash_parameters(Hasher& hasher, const Strategy::ColorCount& strategy) {
+        hasher.add("ColorCount");
+        hasher.add(uint64_t(strategy.count));
+    }
+    inline void hash_parameters(Hasher& hasher, const Strategy::StepCount& strategy) {
+        hasher.add("StepCount");
+        hasher.add(uint64_t(strategy.count));
+        hasher.add(strategy.stop_distance);
+    }
+
+    template<typename Inner>
+    inline void hash_parameters(Hasher& hasher, const Strategy::Collapsed<Inner>& strategy) {
+        hasher.add("Collapsed");
+        hasher.add(strategy.epsilon);
+        hash_parameters(hasher, strategy.inner);
+    }
+
+    /// @brief Stable tag of distance operator
+    inline void hash_operator(Hasher& hasher, const Operator::MaxDifference&) { hasher.add("MaxDifference"); }
+
+    /// @brief Strategy with deterministic result for given parameters.
+    /// Anytime depends on deadline and is not cacheable.
+    template<typename Strategy>
+    concept Cacheable = requires (Hasher & hasher, const Strategy & strategy) { hash_parameters(hasher, strategy); };
+
+    /// @brief Hash of gradient keys, strategy with its parameters, distance operator and output range
+    template<typename DistanceOp, Cacheable Strategy, LinearRange Range>
+        requires requires (Hasher & hasher, const DistanceOp & op) { hash_operator(hasher, op); }
+    [[nodiscard]] inline Digest digest(const Range& gradient, const Builder<Range>& builder, const Strategy& strategy) {
+        constexpr size_t Size = LinearRange_Value<Range>::size;
+
+        Hasher hasher;
+        hash_parameters(hasher, strategy);
+        hash_operator(hasher, DistanceOp{});
+        hasher.add(builder.out_range[0]);
+        hasher.add(builder.out_range[1]);
+
+        hasher.add(uint64_t(Size));
+        hasher.add(uint64_t(std::size(gradient)));
+        for (const auto& key : gradient) {
+            hasher.add(key.position);
+            for (size_t i = 0; i < Size; i++)
+                hasher.add(Detail::channel(key.color, i));
+        }
+
+        return hasher.digest();
+    }
+
+    /// @brief Fitting results by request digest.
+    /// Recently used results are kept in memory, all results are stored in directory if set.
+    /// Directory records use the compact binary format and are written atomically, so caches can be shared between processes.
+    /// Thread safe.
+    template<LinearData TGradient>
+    class ResultCache {
+    public:
+        struct Options {
+            /// @brief Maximal number of results kept in memory
+            size_t max_entries = 1024;
+            /// @brief Persistent store, memory only if empty
+            std::filesystem::path directory;
+        };
+
+        struct Statistics {
+            size_t memory_hits = 0;
+            size_t disk_hits = 0;
+            size_t misses = 0;
+            size_t stores = 0;
+        };
+
+        explicit ResultCache(Options options = {}) : options(std::move(options)) {
+            if (!this->options.directory.empty()) {
+                std::error_code error;
+                std::filesystem::create_directories(this->options.directory, error);
+            }
+        }
+
+        ResultCache(const ResultCache&) = delete;
+        ResultCache& operator=(const ResultCache&) = delete;
+
+        /// @brief Find result in memory or in directory
+        [[nodiscard]] std::optional<TGradient> find(const Digest& digest) {
+            {
+                std::lock_guard lock(mutex);
+                auto found = index.find(digest);
+                if (found != index.end()) {
+                    entries.splice(entries.begin(), entries, found->second);
+                    statistics.memory_hits++;
+                    return found->second->second;
+                }
+            }
+
+            if (auto stored = load(digest)) {
+                std::lock_guard lock(mutex);
+                statistics.disk_hits++;
+                remember(digest, *stored);
+                return stored;
+            }
+
+            std::lock_guard lock(mutex);
+            statistics.misses++;
+            return std::nullopt;
+        }
+
+        /// @brief Add result to memory and directory
+        void insert(const Digest& digest, const TGradient& gradient) {
+            {
+                std::lock_guard lock(mutex);
+                statistics.stores++;
+                remember(digest, gradient);
+            }
+            store(digest, gradient);
+        }
+
+        [[nodiscard]] Statistics stats() const {
+            std::lock_guard lock(mutex);
+            return statistics;
+        }
+
+    private:
+        std::filesystem::path record_path(const Digest& digest) const {
+            const std::string name = digest.to_string();
+            // Two-level layout keeps directories small
+            return options.directory / name.substr(0, 2) / (name.substr(2) + ".itg");
+        }
+
+        std::optional<TGradient> load(const Digest& digest) const {
+            if (options.directory.empty())
+                return std::nullopt;
+
+            std::ifstream input(record_path(digest), std::ios::binary | std::ios::ate);
+            if (!input)
+                return std::nullopt;
+
+            std::vector<char> buffer(static_cast<size_t>(input.tellg()));
+            input.seekg(0);
+            if (!input.read(buffer.data(), buffer.size()))
+                return std::nullopt;
+
+            TGradient gradient;
+            if (Format::from_binary(buffer, gradient).ec != std::errc{})
+                return std::nullopt;
+            return gradient;
+        }
+
+        void store(const Digest& digest, const TGradient& gradient) const {
+            if (options.directory.empty())
+                return;
+
+            std::vector<char> buffer(Format::binary_capacity(gradient));
+            const auto written = Format::to_binary(buffer, gradient);
+            if (written.ec != std::errc{})
+                return;
+
+            const auto path = record_path(digest);
+            std::error_code error;
+            std::filesystem::create_directories(path.parent_path(), error);
+
+            // Readers never see partial records
+            auto temporary = path;
+            temporary += temporary_suffix();
+            {
+                std::ofstream output(temporary, std::ios::binary);
+                output.write(buffer.data(), written.ptr - buffer.data());
+                if (!output)
+                    return;
+            }
+            std::filesystem::rename(temporary, path, error);
+            if (error)
+                std::filesystem::remove(temporary, error);
+        }
+
+        /// @brief Unique per process and thread, so concurrent writers of the same record don't share a temporary file
+        static std::string temporary_suffix() {
+            // Thread ids are only unique within a process
+            static const uint64_t process = (uint64_t(std::random_device{}()) << 32) ^ std::random_device{}();
+            return ".tmp" + std::to_string(process) + "-" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+        }
+
+        void remember(const Digest& digest, const TGradient& gradient) {
+            auto found = index.find(digest);
+            if (found != index.end()) {
+                entries.splice(entries.begin(), entries, found->second);
+                return;
+            }
+
+            entries.emplace_front(digest, gradient);
+            index.emplace(digest, entries.begin());
+
+            while (entries.size() > std::max<size_t>(options.max_entries, 1)) {
+                index.erase(entries.back().first);
+                entries.pop_back();
+            }
+        }
+
+        Options options;
+        mutable std::mutex mutex;
+        /// Most recently used first
+        std::list< std::pair<Digest, TGradient> > entries;
+        std::unordered_map< Digest, typename decltype(entries)::iterator, DigestHash > index;
+        Statistics statistics;
+    };
+
+    /// @brief Fit gradient, or take result of identical earlier request from cache
+    template<typename DistanceOp, Cacheable Strategy, LinearData TGradient>
+    inline [[nodiscard]] TGradient from_gradient(ResultCache<TGradient>& cache, TGradient& gradient, Builder<TGradient>& builder, Strategy&& strategy = {}) {
+        const Digest key = digest<DistanceOp>(gradient, builder, strategy);
+        if (auto cached = cache.find(key))
+            return std::move(*cached);
+
+        TGradient result = from_gradient<DistanceOp>(gradient, builder, std::forward<Strategy>(strategy));
+        cache.insert(key, result);
+        return result;
+    }
+
+    template<typename DistanceOp, Cacheable Strategy, LinearData TGradient>
+    inline [[nodiscard]] TGradient from_gradient(ResultCache<TGradient>& cache, TGradient& gradient, Strategy&& strategy = {}) {
+        Builder<TGradient> builder{};
+        return from_gradient<DistanceOp>(cache, gradient, builder, std::forward<Strategy>(strategy));
+    }
+
+}
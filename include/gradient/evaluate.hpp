@@ -0,0 +1,178 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <ranges>
+#include <span>
+
+#include "gradient/linear.hpp"
+
+namespace ItG::Gradient {
+
+    namespace Detail {
+
+        template<IsColor TColor>
+        inline float& channel(TColor& color, size_t i) {
+            if constexpr (Arithmetic<TColor>)
+                return color;
+            else
+                return color[i];
+        }
+
+        template<IsColor TColor>
+        inline float channel(const TColor& color, size_t i) {
+            if constexpr (Arithmetic<TColor>)
+                return color;
+            else
+                return color[i];
+        }
+
+        /// @brief Index of first position not before value in [first, count)
+        inline size_t lower_bound_index(size_t first, size_t count, auto&& position, float value) {
+            auto indices = std::views::iota(first, count);
+            return *std::ranges::partition_point(indices, [&](size_t i) { return position(i) < value; });
+        }
+
+        /// @brief Evaluate keys at sorted positions in one pass.
+        /// Samples of each key segment are found by binary search first, so the interpolation is a counted loop
+        /// without exits or branches, which compilers vectorize when on_sample is a plain store.
+        /// Positions before first and after last key get the end colors, key with equal positions form a hard step.
+        /// @param count Number of positions
+        /// @param position Callable float(size_t) returning i-th position, positions have to be non-decreasing.
+        /// Called in any order.
+        /// @param on_sample Callable void(size_t, const Color&) receiving i-th evaluated color, called with increasing i
+        template<LinearRange Keys>
+        void sweep(const Keys& keys, size_t count, auto&& position, auto&& on_sample) {
+            using Color = LinearRange_Color<Keys>;
+            constexpr size_t Size = ColorSize<Color>;
+
+            if (std::empty(keys))
+                return;
+
+            auto key = std::begin(keys);
+            const auto end = std::end(keys);
+
+            size_t i = 0;
+            for (const size_t stop = lower_bound_index(i, count, position, key->position); i < stop; i++)
+                on_sample(i, key->color);
+
+            for (auto next = std::next(key); next != end; key = next, ++next) {
+                const float first = key->position;
+                const float last = next->position;
+                if (!(last > first))
+                    continue;
+
+                const float scale = 1.f / (last - first);
+                const Color& from = key->color;
+                Color delta{};
+                for (size_t c = 0; c < Size; c++)
+                    channel(delta, c) = channel(next->color, c) - channel(from, c);
+
+                const size_t stop = lower_bound_index(i, count, position, last);
+                for (size_t j = i; j < stop; j++) {
+                    const float u = (position(j) - first) * scale;
+                    Color color{};
+                    for (size_t c = 0; c < Size; c++)
+                        channel(color, c) = channel(from, c) + channel(delta, c) * u;
+                    on_sample(j, color);
+                }
+                i = stop;
+            }
+
+            for (; i < count; i++)
+                on_sample(i, key->color);
+        }
+
+    }
+
+    /// @brief Evaluate gradient at sorted positions
+    /// @param keys Gradient keys sorted by position
+    /// @param positions Non-decreasing positions
+    /// @param colors Output, has to have at least positions.size() elements
+    template<LinearRange Keys>
+    inline void evaluate(const Keys& keys, std::span<const float> positions, std::span< LinearRange_Color<Keys> > colors) {
+        Detail::sweep(keys, std::min(positions.size(), colors.size()),
+            [&](size_t i) { return positions[i]; },
+            [&](size_t i, const auto& color) { colors[i] = color; });
+    }
+
+    /// @brief Difference of approximation to the original gradient per channel
+    template<size_t N>
+    struct ErrorReport {
+        /// @brief Maximal absolute difference
+        std::array<float, N> max{};
+        /// @brief Mean absolute difference
+        std::array<float, N> mean{};
+        /// @brief Root mean square difference
+        std::array<float, N> rms{};
+        /// @brief Number of compared keys
+        size_t count = 0;
+
+        /// @brief Maximal difference over all channels
+        [[nodiscard]] float max_error() const { return std::ranges::max(max); }
+    };
+
+    /// @brief Measure difference between gradient and the original it was extracted from
+    /// @param keys Approximation keys sorted by position
+    /// @param original Original keys sorted by position, random access
+    template<LinearRange Keys, LinearRange Original> requires SameSize<Keys, Original> && std::ranges::random_access_range<Original>
+    [[nodiscard]] inline ErrorReport< LinearRange_Value<Keys>::size > measure(const Keys& keys, const Original& original) {
+        constexpr size_t Size = LinearRange_Value<Keys>::size;
+
+        ErrorReport<Size> report{};
+        report.count = std::size(original);
+        if (report.count == 0 || std::empty(keys))
+            return report;
+
+        std::array<double, Size> sum{}, sum_squares{};
+        const auto first = std::begin(original);
+
+        Detail::sweep(keys, report.count,
+            [&](size_t i) { return std::next(first, i)->position; },
+            [&](size_t i, const auto& color) {
+                const auto& expected = std::next(first, i)->color;
+                for (size_t c = 0; c < Size; c++) {
+                    const float difference = std::abs(Detail::channel(color, c) - Detail::channel(expected, c));
+                    report.max[c] = std::max(report.max[c], difference);
+                    sum[c] += difference;
+                    sum_squares[c] += double(difference) * difference;
+                }
+            });
+
+        for (size_t c = 0; c < Size; c++) {
+            report.mean[c] = static_cast<float>(sum[c] / report.count);
+            report.rms[c] = static_cast<float>(std::sqrt(sum_squares[c] / report.count));
+        }
+        return report;
+    }
+
+    /// @brief Rasterize gradient into RGBA8 scanline for previews.
+    /// Pixel x is evaluated at x / (width - 1), RGB gradients are opaque.
+    /// @param scanline Output, 4 bytes per pixel
+    template<LinearRange Keys> requires (OfSize<Keys, 3> || OfSize<Keys, 4>)
+    inline void write_rgba8(const Keys& keys, std::span<uint8_t> scanline) {
+        constexpr size_t Size = LinearRange_Value<Keys>::size;
+
+        const size_t width = scanline.size() / 4;
+        const float scale = width > 1 ? 1.f / (width - 1) : 0.f;
+
+        auto to_byte = [](float value) { return static_cast<uint8_t>(std::clamp(value, 0.f, 1.f) * 255.f + 0.5f); };
+
+        Detail::sweep(keys, width,
+            [&](size_t x) { return x * scale; },
+            [&](size_t x, const auto& color) {
+                uint8_t* pixel = scanline.data() + x * 4;
+                pixel[0] = to_byte(color[0]);
+                pixel[1] = to_byte(color[1]);
+                pixel[2] = to_byte(color[2]);
+                if constexpr (Size == 4)
+                    pixel[3] = to_byte(color[3]);
+                else
+                    pixel[3] = 255;
+            });
+    }
+
+}
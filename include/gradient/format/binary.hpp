@@ -0,0 +1,105 @@
+﻿#pragma once
+
+#include <bit>
+#include <cstdint>
+
+#include "gradient/linear.hpp"
+#include "gradient/format/writer.hpp"
+
+namespace ItG::Gradient::Format {
+
+    /// @brief Compact binary layout. All values are little-endian.
+    /// Header: magic "ITGB", uint8 version, uint8 channel count, uint16 reserved, uint32 key count.
+    /// Followed by keys: float32 position, float32 channels[channel count].
+    namespace Binary {
+        constexpr std::string_view magic = "ITGB";
+        constexpr uint8_t version = 1;
+        constexpr size_t header_size = 12;
+
+        /// @brief Size of a single key record
+        template<LinearRange Range>
+        constexpr size_t key_size = sizeof(float) * (1 + LinearRange_Value<Range>::size);
+    }
+
+    /// @brief Exact binary output size
+    template<LinearRange Range>
+    [[nodiscard]] inline size_t binary_capacity(const Range& gradient) {
+        return Binary::header_size + std::size(gradient) * Binary::key_size<Range>;
+    }
+
+    /// @brief Write gradient in compact binary format into buffer
+    /// @param buffer Output buffer
+    /// @param gradient Gradient keys
+    /// @return Pointer past the last written byte, std::errc::value_too_large if buffer is too small
+    template<LinearRange Range>
+    inline std::to_chars_result to_binary(std::span<char> buffer, const Range& gradient) {
+        constexpr size_t Size = LinearRange_Value<Range>::size;
+
+        Writer writer{ buffer };
+
+        writer.put(Binary::magic);
+        writer.put_bytes<uint8_t>(Binary::version);
+        writer.put_bytes<uint8_t>(static_cast<uint8_t>(Size));
+        writer.put_bytes<uint16_t>(0);
+        writer.put_bytes<uint32_t>(static_cast<uint32_t>(std::size(gradient)));
+
+        for (const auto& key : gradient) {
+            writer.put_bytes(std::bit_cast<uint32_t>(static_cast<float>(key.position)));
+            for (size_t i = 0; i < Size; i++) {
+                writer.put_bytes(std::bit_cast<uint32_t>(static_cast<float>(key.color[i])));
+            }
+        }
+
+        return writer.result();
+    }
+
+    /// @brief Read gradient in compact binary format
+    /// @param buffer Input buffer
+    /// @param gradient Output gradient (keys are appended at end)
+    /// @return Pointer past the last read byte, std::errc::invalid_argument if data is malformed or channel count differs
+    template<LinearData TGradient>
+    inline std::from_chars_result from_binary(std::span<const char> buffer, TGradient& gradient) {
+        using Key = TGradient::value_type;
+        constexpr size_t Size = Key::size;
+
+        const char* current = buffer.data();
+        const char* last = buffer.data() + buffer.size();
+
+        auto get_bytes = [&]<typename T>(T& value) {
+            value = 0;
+            for (size_t i = 0; i < sizeof(T); i++) {
+                value |= static_cast<T>(static_cast<uint8_t>(*current++)) << (8 * i);
+            }
+        };
+
+        if (buffer.size() < Binary::header_size || std::string_view(current, Binary::magic.size()) != Binary::magic)
+            return { buffer.data(), std::errc::invalid_argument };
+        current += Binary::magic.size();
+
+        uint8_t version = 0, channels = 0;
+        uint16_t reserved = 0;
+        uint32_t count = 0;
+        get_bytes(version);
+        get_bytes(channels);
+        get_bytes(reserved);
+        get_bytes(count);
+
+        if (version != Binary::version || channels != Size || static_cast<size_t>(last - current) / Binary::key_size<TGradient> < count)
+            return { buffer.data(), std::errc::invalid_argument };
+
+        for (uint32_t i_key = 0; i_key < count; i_key++) {
+            Key key;
+            uint32_t value = 0;
+            get_bytes(value);
+            key.position = std::bit_cast<float>(value);
+            for (size_t i = 0; i < Size; i++) {
+                get_bytes(value);
+                key.color[i] = std::bit_cast<float>(value);
+            }
+            gradient.emplace_back(key);
+        }
+
+        return { current, std::errc{} };
+    }
+
+}
@@ -0,0 +1,60 @@
+﻿#pragma once
+
+#include "gradient/linear.hpp"
+#include "gradient/format/writer.hpp"
+
+namespace ItG::Gradient::Format {
+
+    /// @brief Write color in CSS rgb()/rgba() notation. Channels are in 0-255 range, alpha in percents.
+    template<IsColor TColor> requires (ColorSize<TColor> == 3 || ColorSize<TColor> == 4)
+    inline void put_css_color(Writer& writer, const TColor& color, const Options& options) {
+        constexpr bool has_alpha = ColorSize<TColor> == 4;
+
+        writer.put(has_alpha ? "rgba(" : "rgb(");
+        for (size_t i = 0; i < 3; i++) {
+            if (i > 0)
+                writer.put(", ");
+            writer.put(color[i] * 255.f, options.precision);
+        }
+        if constexpr (has_alpha) {
+            writer.put(", ");
+            writer.put(color[3] * 100.f, options.precision);
+            writer.put('%');
+        }
+        writer.put(')');
+    }
+
+    /// @brief Upper bound of CSS output size
+    template<LinearRange Range>
+    [[nodiscard]] inline size_t css_capacity(const Range& gradient, const Options& options = {}) {
+        // "rgba(" + 4 numbers, separators, "%) " + position and "%"
+        const size_t key_size = 4 * number_capacity(options) + 16 + number_capacity(options);
+        return 32 + number_capacity(options) + std::size(gradient) * key_size;
+    }
+
+    /// @brief Write CSS linear-gradient() into buffer
+    /// @param buffer Output buffer
+    /// @param gradient Gradient keys (RGB or RGBA)
+    /// @param options Formatting options
+    /// @param angle Gradient angle in degrees
+    /// @return Pointer past the last written character, std::errc::value_too_large if buffer is too small
+    template<LinearRange Range> requires (OfSize<Range, 3> || OfSize<Range, 4>)
+    inline std::to_chars_result to_css(std::span<char> buffer, const Range& gradient, const Options& options = {}, float angle = 90.f) {
+        Writer writer{ buffer };
+
+        writer.put("linear-gradient(");
+        writer.put(angle, options.precision);
+        writer.put("deg");
+        for (const auto& key : gradient) {
+            writer.put(", ");
+            put_css_color(writer, key.color, options);
+            writer.put(' ');
+            writer.put(key.position * 100.f, options.precision);
+            writer.put('%');
+        }
+        writer.put(')');
+
+        return writer.result();
+    }
+
+}
@@ -0,0 +1,50 @@
+﻿#pragma once
+
+#include "gradient/linear.hpp"
+#include "gradient/format/writer.hpp"
+
+namespace ItG::Gradient::Format {
+
+    /// @brief Upper bound of JSON output size
+    template<LinearRange Range>
+    [[nodiscard]] inline size_t json_capacity(const Range& gradient, const Options& options = {}) {
+        constexpr size_t Size = LinearRange_Value<Range>::size;
+        // {"position":,"color":[]} with separators
+        const size_t key_size = (Size + 1) * (number_capacity(options) + 1) + 32;
+        return 2 + std::size(gradient) * key_size;
+    }
+
+    /// @brief Write gradient as JSON array of {"position": p, "color": [c...]} objects into buffer
+    /// @param buffer Output buffer
+    /// @param gradient Gradient keys
+    /// @param options Formatting options
+    /// @return Pointer past the last written character, std::errc::value_too_large if buffer is too small
+    template<LinearRange Range>
+    inline std::to_chars_result to_json(std::span<char> buffer, const Range& gradient, const Options& options = {}) {
+        constexpr size_t Size = LinearRange_Value<Range>::size;
+
+        Writer writer{ buffer };
+
+        writer.put('[');
+        bool first = true;
+        for (const auto& key : gradient) {
+            if (!first)
+                writer.put(',');
+            first = false;
+
+            writer.put("{\"position\":");
+            writer.put(key.position, options.precision);
+            writer.put(",\"color\":[");
+            for (size_t i = 0; i < Size; i++) {
+                if (i > 0)
+                    writer.put(',');
+                writer.put(key.color[i], options.precision);
+            }
+            writer.put("]}");
+        }
+        writer.put(']');
+
+        return writer.result();
+    }
+
+}
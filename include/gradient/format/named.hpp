@@ -0,0 +1,56 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "gradient/linear.hpp"
+#include "gradient/format/css.hpp"
+#include "gradient/format/svg.hpp"
+#include "gradient/format/json.hpp"
+#include "gradient/format/binary.hpp"
+
+namespace ItG::Gradient::Format {
+
+    /// @brief Output file extension of format "css", "svg", "json" or "binary", empty for unknown format
+    [[nodiscard]] inline std::string_view extension(std::string_view format) {
+        if (format == "binary")
+            return ".itg";
+        if (format == "css")
+            return ".css";
+        if (format == "svg")
+            return ".svg";
+        if (format == "json")
+            return ".json";
+        return {};
+    }
+
+    /// @brief Write gradient in format given by name with default options, buffer is resized if needed
+    /// @param format "css", "svg", "json" or "binary"
+    /// @return Written output in buffer, empty for unknown format or on failure
+    template<LinearRange Range>
+    inline std::string_view to_named(std::string_view format, const Range& gradient, std::vector<char>& buffer) {
+        std::to_chars_result written{};
+        if (format == "css") {
+            buffer.resize(std::max(buffer.size(), css_capacity(gradient)));
+            written = to_css(buffer, gradient);
+        } else if (format == "svg") {
+            buffer.resize(std::max(buffer.size(), svg_capacity(gradient)));
+            written = to_svg(buffer, gradient);
+        } else if (format == "json") {
+            buffer.resize(std::max(buffer.size(), json_capacity(gradient)));
+            written = to_json(buffer, gradient);
+        } else if (format == "binary") {
+            buffer.resize(std::max(buffer.size(), binary_capacity(gradient)));
+            written = to_binary(buffer, gradient);
+        } else {
+            return {};
+        }
+
+        if (written.ec != std::errc{})
+            return {};
+        return { buffer.data(), written.ptr };
+    }
+
+}
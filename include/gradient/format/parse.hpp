@@ -0,0 +1,557 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string_view>
+#include <system_error>
+
+#include "gradient/linear.hpp"
+
+namespace ItG::Gradient::Format {
+
+    /// @brief Sequential reader over text. Does not allocate.
+    /// Matching functions skip leading whitespace and leave position unchanged if they fail.
+    struct Reader {
+        const char* current = nullptr;
+        const char* last = nullptr;
+
+        explicit Reader(std::string_view text) : current(text.data()), last(text.data() + text.size()) {}
+
+        [[nodiscard]] bool at_end() const { return current == last; }
+
+        [[nodiscard]] char peek() const { return current == last ? '\0' : *current; }
+
+        void skip_space() {
+            while (current != last && (*current == ' ' || *current == '\t' || *current == '\n' || *current == '\r' || *current == '\f'))
+                ++current;
+        }
+
+        bool consume(char value) {
+            skip_space();
+            if (current == last || *current != value)
+                return false;
+            ++current;
+            return true;
+        }
+
+        /// @brief Match ASCII word case-insensitively
+        bool consume(std::string_view word) {
+            skip_space();
+            if (static_cast<size_t>(last - current) < word.size())
+                return false;
+            for (size_t i = 0; i < word.size(); i++) {
+                if (lower(current[i]) != lower(word[i]))
+                    return false;
+            }
+            current += word.size();
+            return true;
+        }
+
+        /// @brief Locale independent number, leading '+' is accepted
+        bool number(float& value) {
+            skip_space();
+            const char* first = current;
+            if (first != last && *first == '+')
+                ++first;
+
+            const auto result = std::from_chars(first, last, value);
+            if (result.ec != std::errc{})
+                return false;
+            current = result.ptr;
+            return true;
+        }
+
+        /// @brief Move past the next occurrence of value outside of parentheses
+        bool skip_past(char value) {
+            int depth = 0;
+            for (; current != last; ++current) {
+                if (*current == value && depth == 0) {
+                    ++current;
+                    return true;
+                }
+                depth += (*current == '(') - (*current == ')');
+                if (depth < 0)
+                    return false;
+            }
+            return false;
+        }
+
+        static constexpr char lower(char value) {
+            return (value >= 'A' && value <= 'Z') ? static_cast<char>(value - 'A' + 'a') : value;
+        }
+    };
+
+    namespace Parse {
+
+        inline int hex_digit(char value) {
+            if (value >= '0' && value <= '9')
+                return value - '0';
+            value = Reader::lower(value);
+            if (value >= 'a' && value <= 'f')
+                return value - 'a' + 10;
+            return -1;
+        }
+
+        /// @brief #rgb, #rgba, #rrggbb or #rrggbbaa
+        inline bool read_hex(Reader& reader, Color::RGBA& color) {
+            const char* first = reader.current;
+            const char* end = first;
+            while (end != reader.last && hex_digit(*end) >= 0)
+                ++end;
+
+            const size_t count = end - first;
+            if (count != 3 && count != 4 && count != 6 && count != 8)
+                return false;
+
+            const bool is_short = count <= 4;
+            const size_t channels = is_short ? count : count / 2;
+            color[3] = 1.f;
+            for (size_t i = 0; i < channels; i++) {
+                const int value = is_short
+                    ? hex_digit(first[i]) * 17
+                    : hex_digit(first[2 * i]) * 16 + hex_digit(first[2 * i + 1]);
+                color[i] = value / 255.f;
+            }
+
+            reader.current = end;
+            return true;
+        }
+
+        /// @brief Channel as number in 0-255 range or percentage
+        inline bool read_channel(Reader& reader, float& value) {
+            if (!reader.number(value))
+                return false;
+            value = reader.consume('%') ? value / 100.f : value / 255.f;
+            value = std::clamp(value, 0.f, 1.f);
+            return true;
+        }
+
+        /// @brief Alpha as number in 0-1 range or percentage
+        inline bool read_alpha(Reader& reader, float& value) {
+            if (!reader.number(value))
+                return false;
+            if (reader.consume('%'))
+                value /= 100.f;
+            value = std::clamp(value, 0.f, 1.f);
+            return true;
+        }
+
+        struct NamedColor {
+            std::string_view name;
+            uint32_t rgb;
+        };
+
+        /// @brief CSS named colors, sorted by name
+        inline constexpr std::array<NamedColor, 148> named_colors{ {
+            { "aliceblue", 0xf0f8ff }, { "antiquewhite", 0xfaebd7 }, { "aqua", 0x00ffff }, { "aquamarine", 0x7fffd4 }, { "azure", 0xf0ffff },
+            { "beige", 0xf5f5dc }, { "bisque", 0xffe4c4 }, { "black", 0x000000 }, { "blanchedalmond", 0xffebcd }, { "blue", 0x0000ff },
+            { "blueviolet", 0x8a2be2 }, { "brown", 0xa52a2a }, { "burlywood", 0xdeb887 }, { "cadetblue", 0x5f9ea0 }, { "chartreuse", 0x7fff00 },
+            { "chocolate", 0xd2691e }, { "coral", 0xff7f50 }, { "cornflowerblue", 0x6495ed }, { "cornsilk", 0xfff8dc }, { "crimson", 0xdc143c },
+            { "cyan", 0x00ffff }, { "darkblue", 0x00008b }, { "darkcyan", 0x008b8b }, { "darkgoldenrod", 0xb8860b }, { "darkgray", 0xa9a9a9 },
+            { "darkgreen", 0x006400 }, { "darkgrey", 0xa9a9a9 }, { "darkkhaki", 0xbdb76b }, { "darkmagenta", 0x8b008b },
+            { "darkolivegreen", 0x556b2f }, { "darkorange", 0xff8c00 }, { "darkorchid", 0x9932cc }, { "darkred", 0x8b0000 },
+            { "darksalmon", 0xe9967a }, { "darkseagreen", 0x8fbc8f }, { "darkslateblue", 0x483d8b }, { "darkslategray", 0x2f4f4f },
+            { "darkslategrey", 0x2f4f4f }, { "darkturquoise", 0x00ced1 }, { "darkviolet", 0x9400d3 }, { "deeppink", 0xff1493 },
+            { "deepskyblue", 0x00bfff }, { "dimgray", 0x696969 }, { "dimgrey", 0x696969 }, { "dodgerblue", 0x1e90ff }, { "firebrick", 0xb22222 },
+            { "floralwhite", 0xfffaf0 }, { "forestgreen", 0x228b22 }, { "fuchsia", 0xff00ff }, { "gainsboro", 0xdcdcdc }, { "ghostwhite", 0xf8f8ff },
+            { "gold", 0xffd700 }, { "goldenrod", 0xdaa520 }, { "gray", 0x808080 }, { "green", 0x008000 }, { "greenyellow", 0xadff2f },
+            { "grey", 0x808080 }, { "honeydew", 0xf0fff0 }, { "hotpink", 0xff69b4 }, { "indianred", 0xcd5c5c }, { "indigo", 0x4b0082 },
+            { "ivory", 0xfffff0 }, { "khaki", 0xf0e68c }, { "lavender", 0xe6e6fa }, { "lavenderblush", 0xfff0f5 }, { "lawngreen", 0x7cfc00 },
+            { "lemonchiffon", 0xfffacd }, { "lightblue", 0xadd8e6 }, { "lightcoral", 0xf08080 }, { "lightcyan", 0xe0ffff },
+            { "lightgoldenrodyellow", 0xfafad2 }, { "lightgray", 0xd3d3d3 }, { "lightgreen", 0x90ee90 }, { "lightgrey", 0xd3d3d3 },
+            { "lightpink", 0xffb6c1 }, { "lightsalmon", 0xffa07a }, { "lightseagreen", 0x20b2aa }, { "lightskyblue", 0x87cefa },
+            { "lightslategray", 0x778899 }, { "lightslategrey", 0x778899 }, { "lightsteelblue", 0xb0c4de }, { "lightyellow", 0xffffe0 },
+            { "lime", 0x00ff00 }, { "limegreen", 0x32cd32 }, { "linen", 0xfaf0e6 }, { "magenta", 0xff00ff }, { "maroon", 0x800000 },
+            { "mediumaquamarine", 0x66cdaa }, { "mediumblue", 0x0000cd }, { "mediumorchid", 0xba55d3 }, { "mediumpurple", 0x9370db },
+            { "mediumseagreen", 0x3cb371 }, { "mediumslateblue", 0x7b68ee }, { "mediumspringgreen", 0x00fa9a }, { "mediumturquoise", 0x48d1cc },
+            { "mediumvioletred", 0xc71585 }, { "midnightblue", 0x191970 }, { "mintcream", 0xf5fffa }, { "mistyrose", 0xffe4e1 },
+            { "moccasin", 0xffe4b5 }, { "navajowhite", 0xffdead }, { "navy", 0x000080 }, { "oldlace", 0xfdf5e6 }, { "olive", 0x808000 },
+            { "olivedrab", 0x6b8e23 }, { "orange", 0xffa500 }, { "orangered", 0xff4500 }, { "orchid", 0xda70d6 }, { "palegoldenrod", 0xeee8aa },
+            { "palegreen", 0x98fb98 }, { "paleturquoise", 0xafeeee }, { "palevioletred", 0xdb7093 }, { "papayawhip", 0xffefd5 },
+            { "peachpuff", 0xffdab9 }, { "peru", 0xcd853f }, { "pink", 0xffc0cb }, { "plum", 0xdda0dd }, { "powderblue", 0xb0e0e6 },
+            { "purple", 0x800080 }, { "rebeccapurple", 0x663399 }, { "red", 0xff0000 }, { "rosybrown", 0xbc8f8f }, { "royalblue", 0x4169e1 },
+            { "saddlebrown", 0x8b4513 }, { "salmon", 0xfa8072 }, { "sandybrown", 0xf4a460 }, { "seagreen", 0x2e8b57 }, { "seashell", 0xfff5ee },
+            { "sienna", 0xa0522d }, { "silver", 0xc0c0c0 }, { "skyblue", 0x87ceeb }, { "slateblue", 0x6a5acd }, { "slategray", 0x708090 },
+            { "slategrey", 0x708090 }, { "snow", 0xfffafa }, { "springgreen", 0x00ff7f }, { "steelblue", 0x4682b4 }, { "tan", 0xd2b48c },
+            { "teal", 0x008080 }, { "thistle", 0xd8bfd8 }, { "tomato", 0xff6347 }, { "turquoise", 0x40e0d0 }, { "violet", 0xee82ee },
+            { "wheat", 0xf5deb3 }, { "white", 0xffffff }, { "whitesmoke", 0xf5f5f5 }, { "yellow", 0xffff00 }, { "yellowgreen", 0x9acd32 },
+        } };
+
+        /// @brief CSS named color or transparent, case-insensitive
+        inline bool read_named(Reader& reader, Color::RGBA& color) {
+            reader.skip_space();
+            const char* first = reader.current;
+            const char* end = first;
+            while (end != reader.last && std::isalpha(static_cast<unsigned char>(*end)))
+                ++end;
+
+            // Longest name is lightgoldenrodyellow
+            std::array<char, 24> buffer;
+            const size_t length = static_cast<size_t>(end - first);
+            if (length == 0 || length > buffer.size())
+                return false;
+            for (size_t i = 0; i < length; i++)
+                buffer[i] = Reader::lower(first[i]);
+            const std::string_view name(buffer.data(), length);
+
+            if (name == "transparent") {
+                color = { 0.f, 0.f, 0.f, 0.f };
+                reader.current = end;
+                return true;
+            }
+
+            const auto found = std::ranges::lower_bound(named_colors, name, {}, &NamedColor::name);
+            if (found == named_colors.end() || found->name != name)
+                return false;
+
+            color = { ((found->rgb >> 16) & 0xff) / 255.f, ((found->rgb >> 8) & 0xff) / 255.f, (found->rgb & 0xff) / 255.f, 1.f };
+            reader.current = end;
+            return true;
+        }
+
+        /// @brief rgb()/rgba() with comma or space separated channels, hex or named color
+        inline bool read_color(Reader& reader, Color::RGBA& color) {
+            const Reader start = reader;
+
+            if (reader.consume('#')) {
+                if (read_hex(reader, color))
+                    return true;
+                reader = start;
+                return false;
+            }
+
+            if (reader.consume("rgba(") || reader.consume("rgb(")) {
+                color[3] = 1.f;
+                bool valid = read_channel(reader, color[0]);
+                for (size_t i = 1; i < 3 && valid; i++) {
+                    reader.consume(',');
+                    valid = read_channel(reader, color[i]);
+                }
+                if (valid && (reader.consume(',') || reader.consume('/')))
+                    valid = read_alpha(reader, color[3]);
+                if (valid && reader.consume(')'))
+                    return true;
+                reader = start;
+                return false;
+            }
+
+            return read_named(reader, color);
+        }
+
+        /// @brief Skip direction argument with its comma: "to" side or corner, or angle in deg, grad, rad or turn
+        inline bool skip_direction(Reader& reader) {
+            const Reader start = reader;
+
+            if (reader.consume("to") && std::isspace(static_cast<unsigned char>(reader.peek()))) {
+                if (reader.skip_past(','))
+                    return true;
+                reader = start;
+                return false;
+            }
+            reader = start;
+
+            float angle = 0.f;
+            if (reader.number(angle) && std::isalpha(static_cast<unsigned char>(reader.peek()))
+                && (reader.consume("deg") || reader.consume("grad") || reader.consume("rad") || reader.consume("turn"))
+                && reader.consume(','))
+                return true;
+            reader = start;
+            return false;
+        }
+
+        /// @brief Percentage or unitless zero, as fraction
+        inline bool read_position(Reader& reader, float& position) {
+            const Reader start = reader;
+            if (!reader.number(position))
+                return false;
+            if (reader.consume('%')) {
+                position /= 100.f;
+                return true;
+            }
+            if (position == 0.f && !std::isalpha(static_cast<unsigned char>(reader.peek())))
+                return true;
+            reader = start;
+            return false;
+        }
+
+        template<LinearData TGradient>
+        inline void append(TGradient& gradient, const Color::RGBA& color, float position) {
+            using Key = typename TGradient::value_type;
+            typename Key::color_type key_color;
+            for (size_t i = 0; i < Key::size; i++)
+                key_color[i] = color[i];
+            gradient.emplace_back(key_color, position);
+        }
+
+        /// @brief Resolve positions of keys from first on, as CSS does for color stops.
+        /// Missing (NaN) ends are 0 and 1, positions lower than a previous one are raised to it,
+        /// other missing positions are spread evenly between their neighbours.
+        template<LinearData TGradient>
+        inline void fix_positions(TGradient& gradient, size_t first) {
+            const size_t count = gradient.size() - first;
+            if (count == 0)
+                return;
+
+            auto position = [&](size_t i) -> float& { return gradient[first + i].position; };
+
+            if (std::isnan(position(0)))
+                position(0) = 0.f;
+            if (std::isnan(position(count - 1)))
+                position(count - 1) = 1.f;
+
+            float highest = position(0);
+            size_t previous = 0;
+            for (size_t i = 1; i < count; i++) {
+                if (std::isnan(position(i)))
+                    continue;
+
+                position(i) = std::max(position(i), highest);
+                highest = position(i);
+
+                for (size_t j = previous + 1; j < i; j++)
+                    position(j) = std::lerp(position(previous), position(i), float(j - previous) / float(i - previous));
+                previous = i;
+            }
+        }
+
+        constexpr std::string_view css_function = "linear-gradient(";
+        constexpr std::string_view svg_element = "<linearGradient";
+    }
+
+    /// @brief Read CSS linear-gradient() at start of text, after optional whitespace.
+    /// Stops may have rgb()/rgba() (comma or space syntax, numbers or percentages), hex or named colors,
+    /// and zero, one or two percentage positions. Missing positions are resolved as in CSS.
+    /// Direction ("to" side or angle) and interpolation hints are skipped, as gradient keys have no direction.
+    /// Other color syntaxes (hsl(), currentColor, ...) make the gradient invalid.
+    /// @param text Input text
+    /// @param gradient Output gradient (RGB or RGBA, keys are appended at end)
+    /// @return Pointer past closing parenthesis, std::errc::invalid_argument if text does not start with a supported gradient
+    template<LinearData TGradient> requires (OfSize<TGradient, 3> || OfSize<TGradient, 4>)
+    inline std::from_chars_result from_css(std::string_view text, TGradient& gradient) {
+        constexpr float missing = std::numeric_limits<float>::quiet_NaN();
+
+        Reader reader{ text };
+        const size_t first = gradient.size();
+        auto fail = [&]() -> std::from_chars_result {
+            while (gradient.size() > first)
+                gradient.pop_back();
+            return { text.data(), std::errc::invalid_argument };
+        };
+
+        if (!reader.consume(Parse::css_function))
+            return fail();
+
+        // Optional direction, any other first argument has to be a color stop
+        Parse::skip_direction(reader);
+
+        Color::RGBA color{};
+        for (;;) {
+            float position = missing;
+            if (Parse::read_color(reader, color)) {
+                const bool has_position = Parse::read_position(reader, position);
+                Parse::append(gradient, color, position);
+
+                float second = missing;
+                if (has_position && Parse::read_position(reader, second))
+                    Parse::append(gradient, color, second);
+            } else if (!Parse::read_position(reader, position)) {
+                // Interpolation hint is a position alone
+                return fail();
+            }
+
+            if (reader.consume(')'))
+                break;
+            if (!reader.consume(','))
+                return fail();
+        }
+
+        if (gradient.size() - first < 2)
+            return fail();
+
+        Parse::fix_positions(gradient, first);
+        return { reader.current, std::errc{} };
+    }
+
+    /// @brief Read SVG <linearGradient> element at start of text, after optional whitespace.
+    /// Stop colors and opacities are read from attributes and style, colors are parsed as in from_css.
+    /// Unreadable offset, stop-color or stop-opacity makes the gradient invalid.
+    /// Offsets are numbers or percentages, clamped to [0, 1] and raised to previous offset as in SVG.
+    /// @param text Input text
+    /// @param gradient Output gradient (RGB or RGBA, keys are appended at end)
+    /// @return Pointer past closing tag, std::errc::invalid_argument if text does not start with a supported gradient
+    template<LinearData TGradient> requires (OfSize<TGradient, 3> || OfSize<TGradient, 4>)
+    inline std::from_chars_result from_svg(std::string_view text, TGradient& gradient) {
+        Reader reader{ text };
+        const size_t first = gradient.size();
+        auto fail = [&]() -> std::from_chars_result {
+            while (gradient.size() > first)
+                gradient.pop_back();
+            return { text.data(), std::errc::invalid_argument };
+        };
+
+        if (!reader.consume(Parse::svg_element))
+            return fail();
+
+        auto skip_tag = [&]() {
+            const char* end = std::find(reader.current, reader.last, '>');
+            const bool closed = end != reader.last && end[-1] == '/';
+            reader.current = end == reader.last ? end : end + 1;
+            return closed;
+        };
+
+        if (skip_tag())
+            return fail();
+
+        float highest = 0.f;
+        for (;;) {
+            reader.current = std::find(reader.current, reader.last, '<');
+            if (reader.at_end())
+                return fail();
+
+            if (reader.consume("</lineargradient")) {
+                skip_tag();
+                break;
+            }
+            if (!reader.consume("<stop")) {
+                skip_tag();
+                continue;
+            }
+
+            float offset = 0.f;
+            float opacity = 1.f;
+            Color::RGBA color{ 0.f, 0.f, 0.f, 1.f };
+
+            // False if value of a known attribute can't be read
+            auto attribute = [&](std::string_view name, std::string_view value) {
+                Reader value_reader{ value };
+                if (name == "offset") {
+                    if (!value_reader.number(offset))
+                        return false;
+                    if (value_reader.consume('%'))
+                        offset /= 100.f;
+                } else if (name == "stop-color") {
+                    return Parse::read_color(value_reader, color);
+                } else if (name == "stop-opacity") {
+                    return Parse::read_alpha(value_reader, opacity);
+                }
+                return true;
+            };
+
+            // Attributes up to end of tag
+            for (;;) {
+                reader.skip_space();
+                if (reader.consume("/>") || reader.consume('>'))
+                    break;
+
+                const char* name = reader.current;
+                while (!reader.at_end() && (std::isalnum(static_cast<unsigned char>(*reader.current)) || *reader.current == '-' || *reader.current == ':'))
+                    ++reader.current;
+                const std::string_view attribute_name(name, reader.current - name);
+
+                if (attribute_name.empty() || !reader.consume('='))
+                    return fail();
+                reader.skip_space();
+                const char quote = reader.peek();
+                if (quote != '"' && quote != '\'')
+                    return fail();
+
+                const char* value = ++reader.current;
+                reader.current = std::find(reader.current, reader.last, quote);
+                if (reader.at_end())
+                    return fail();
+                const std::string_view attribute_value(value, reader.current - value);
+                ++reader.current;
+
+                if (attribute_name != "style") {
+                    if (!attribute(attribute_name, attribute_value))
+                        return fail();
+                    continue;
+                }
+
+                // style="stop-color: #fff; stop-opacity: 0.5"
+                for (size_t start = 0; start < attribute_value.size();) {
+                    size_t end = attribute_value.find(';', start);
+                    if (end == attribute_value.npos)
+                        end = attribute_value.size();
+                    const std::string_view declaration = attribute_value.substr(start, end - start);
+                    const size_t colon = declaration.find(':');
+                    if (colon != declaration.npos) {
+                        std::string_view property = declaration.substr(0, colon);
+                        while (!property.empty() && (property.front() == ' ' || property.front() == '\t' || property.front() == '\n'))
+                            property.remove_prefix(1);
+                        while (!property.empty() && (property.back() == ' ' || property.back() == '\t' || property.back() == '\n'))
+                            property.remove_suffix(1);
+                        if (!attribute(property, declaration.substr(colon + 1)))
+                            return fail();
+                    }
+                    start = end + 1;
+                }
+            }
+
+            highest = std::max(std::clamp(offset, 0.f, 1.f), highest);
+            color[3] *= opacity;
+            Parse::append(gradient, color, highest);
+        }
+
+        if (gradient.size() == first)
+            return fail();
+
+        return { reader.current, std::errc{} };
+    }
+
+    /// @brief Syntax of gradients read by GradientReader
+    enum class Syntax { CSS, SVG };
+
+    /// @brief Reads all gradients of one syntax from text in a single pass, for example a whole stylesheet or SVG file.
+    /// Text between gradients is skipped, malformed gradients are skipped and counted.
+    /// Output gradient is reused, so reading does not allocate once its capacity is large enough.
+    class GradientReader {
+    public:
+        GradientReader(std::string_view text, Syntax syntax) : text(text), syntax(syntax) {}
+
+        /// @brief Read next gradient
+        /// @param gradient Output gradient, previous content is replaced
+        /// @return false if there are no more gradients
+        template<LinearData TGradient> requires (OfSize<TGradient, 3> || OfSize<TGradient, 4>)
+        bool next(TGradient& gradient) {
+            const std::string_view token = syntax == Syntax::CSS ? Parse::css_function : Parse::svg_element;
+
+            for (;;) {
+                const size_t found = text.find(token);
+                if (found == text.npos) {
+                    text = {};
+                    return false;
+                }
+                text.remove_prefix(found);
+
+                gradient.clear();
+                const auto result = syntax == Syntax::CSS ? from_css(text, gradient) : from_svg(text, gradient);
+                if (result.ec == std::errc{}) {
+                    text.remove_prefix(result.ptr - text.data());
+                    return true;
+                }
+
+                malformed++;
+                text.remove_prefix(token.size());
+            }
+        }
+
+        /// @brief Number of skipped malformed gradients
+        [[nodiscard]] size_t errors() const { return malformed; }
+
+        /// @brief Number of characters not read yet, for progress reporting
+        [[nodiscard]] size_t remaining() const { return text.size(); }
+
+    private:
+        std::string_view text;
+        Syntax syntax;
+        size_t malformed = 0;
+    };
+
+}
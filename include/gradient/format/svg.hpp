@@ -0,0 +1,53 @@
+﻿#pragma once
+
+#include "gradient/linear.hpp"
+#include "gradient/format/writer.hpp"
+
+namespace ItG::Gradient::Format {
+
+    /// @brief Upper bound of SVG output size
+    template<LinearRange Range>
+    [[nodiscard]] inline size_t svg_capacity(const Range& gradient, std::string_view id = "gradient", const Options& options = {}) {
+        // <stop offset="%" stop-color="rgb(, , )" stop-opacity=""/> with 5 numbers
+        const size_t key_size = 5 * number_capacity(options) + 64;
+        return 64 + id.size() + std::size(gradient) * key_size;
+    }
+
+    /// @brief Write SVG <linearGradient> element into buffer
+    /// @param buffer Output buffer
+    /// @param gradient Gradient keys (RGB or RGBA)
+    /// @param id Element identifier
+    /// @param options Formatting options
+    /// @return Pointer past the last written character, std::errc::value_too_large if buffer is too small
+    template<LinearRange Range> requires (OfSize<Range, 3> || OfSize<Range, 4>)
+    inline std::to_chars_result to_svg(std::span<char> buffer, const Range& gradient, std::string_view id = "gradient", const Options& options = {}) {
+        constexpr bool has_alpha = OfSize<Range, 4>;
+
+        Writer writer{ buffer };
+
+        writer.put("<linearGradient id=\"");
+        writer.put(id);
+        writer.put("\">\n");
+        for (const auto& key : gradient) {
+            writer.put("  <stop offset=\"");
+            writer.put(key.position * 100.f, options.precision);
+            writer.put("%\" stop-color=\"rgb(");
+            for (size_t i = 0; i < 3; i++) {
+                if (i > 0)
+                    writer.put(", ");
+                writer.put(key.color[i] * 255.f, options.precision);
+            }
+            writer.put(")\"");
+            if constexpr (has_alpha) {
+                writer.put(" stop-opacity=\"");
+                writer.put(key.color[3], options.precision);
+                writer.put('"');
+            }
+            writer.put("/>\n");
+        }
+        writer.put("</linearGradient>");
+
+        return writer.result();
+    }
+
+}
@@ -0,0 +1,97 @@
+﻿#pragma once
+
+#include <span>
+#include <algorithm>
+#include <type_traits>
+#include <charconv>
+#include <string_view>
+#include <system_error>
+
+namespace ItG::Gradient::Format {
+
+    /// @brief Output formatting options
+    struct Options {
+        /// @brief Maximal number of digits after decimal point. Trailing zeros are omitted.
+        int precision = 2;
+    };
+
+    /// @brief Upper bound of characters written for a single number
+    /// @param options Formatting options
+    constexpr size_t number_capacity(const Options& options) {
+        // sign, 39 integer digits of float max, decimal point and fraction
+        return 41 + static_cast<size_t>(std::max(options.precision, 0));
+    }
+
+    /// @brief Sequential writer into caller-provided buffer. Does not allocate.
+    /// Stops writing on first overflow and reports std::errc::value_too_large.
+    struct Writer {
+        char* current = nullptr;
+        char* last = nullptr;
+        bool overflow = false;
+
+        explicit Writer(std::span<char> buffer) : current(buffer.data()), last(buffer.data() + buffer.size()) {}
+
+        void put(char value) {
+            if (overflow || current == last) {
+                overflow = true;
+                return;
+            }
+            *current++ = value;
+        }
+
+        void put(std::string_view text) {
+            if (overflow || static_cast<size_t>(last - current) < text.size()) {
+                overflow = true;
+                return;
+            }
+            current = std::copy(text.begin(), text.end(), current);
+        }
+
+        /// @brief Write locale independent fixed point number
+        void put(float value, int precision) {
+            if (overflow)
+                return;
+
+            auto [end, error] = std::to_chars(current, last, value, std::chars_format::fixed, std::max(precision, 0));
+            if (error != std::errc{}) {
+                overflow = true;
+                return;
+            }
+
+            // Trim trailing zeros of fraction
+            if (std::find(current, end, '.') != end) {
+                while (*(end - 1) == '0')
+                    --end;
+                if (*(end - 1) == '.')
+                    --end;
+            }
+
+            // Avoid "-0" for values rounded to zero
+            if (end - current == 2 && current[0] == '-' && current[1] == '0') {
+                current[0] = '0';
+                --end;
+            }
+
+            current = end;
+        }
+
+        /// @brief Write little-endian bytes of unsigned value
+        template<typename T> requires std::is_unsigned_v<T>
+        void put_bytes(T value) {
+            if (overflow || static_cast<size_t>(last - current) < sizeof(T)) {
+                overflow = true;
+                return;
+            }
+            for (size_t i = 0; i < sizeof(T); i++) {
+                *current++ = static_cast<char>((value >> (8 * i)) & 0xFF);
+            }
+        }
+
+        [[nodiscard]] std::to_chars_result result() const {
+            if (overflow)
+                return { last, std::errc::value_too_large };
+            return { current, std::errc{} };
+        }
+    };
+
+}
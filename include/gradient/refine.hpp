@@ -0,0 +1,180 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <ranges>
+#include <thread>
+#include <vector>
+
+#include "gradient/linear.hpp"
+#include "gradient/builder.hpp"
+#include "gradient/strategy/approximate.hpp"
+#include "gradient/strategy/find_farthest.hpp"
+
+namespace ItG::Gradient {
+
+    /// @brief Parameters of refine
+    struct Refine {
+        /// @brief Maximal distance between extracted end original gradient, as Approximate::tolerance
+        float tolerance = 4.f / 255.f;
+        /// @brief Threads checking intervals, inline if 1
+        size_t threads = 1;
+        /// @brief Minimal number of intervals per thread, smaller key sets are checked inline
+        size_t min_intervals = 64;
+    };
+
+    namespace Detail {
+
+        /// @brief Call function(i) for i in [0, count), split into contiguous chunks over threads
+        template<typename Function>
+        void parallel_for(size_t count, const Refine& params, Function&& function) {
+            const size_t threads = std::min(std::max<size_t>(params.threads, 1), std::max<size_t>(count / std::max<size_t>(params.min_intervals, 1), 1));
+            if (threads <= 1) {
+                for (size_t i = 0; i < count; i++)
+                    function(i);
+                return;
+            }
+
+            std::vector<std::thread> workers;
+            const size_t chunk = (count + threads - 1) / threads;
+            for (size_t first = chunk; first < count; first += chunk) {
+                workers.emplace_back([&, first]() {
+                    for (size_t i = first; i < std::min(first + chunk, count); i++)
+                        function(i);
+                });
+            }
+            for (size_t i = 0; i < chunk; i++)
+                function(i);
+            for (auto& worker : workers)
+                worker.join();
+        }
+
+        /// @brief Index of original key matching key: same position, same color if there is one
+        template<LinearData TGradient>
+        size_t find_key(const TGradient& original, const LinearRange_Value<TGradient>& key) {
+            auto first = std::ranges::lower_bound(original, key.position, {}, &LinearRange_Value<TGradient>::position);
+            for (auto it = first; it != std::end(original) && it->position == key.position; ++it) {
+                if (it->color == key.color)
+                    return static_cast<size_t>(std::distance(std::begin(original), it));
+            }
+            // Position not in original, nearest key at or after it
+            return std::min(static_cast<size_t>(std::distance(std::begin(original), first)), std::size(original) - 1);
+        }
+
+    }
+
+    /// @brief Extract keys starting from an existing key set, e.g. after a small change of tolerance or of the original gradient.
+    /// Previous keys are matched to original keys by position. Each interval between them is checked against the original in one pass,
+    /// intervals farther than tolerance are split as Approximate does. Adjacent intervals within tolerance are merged in rounds
+    /// while the merged interval is within tolerance too, until no shared key can be dropped. Every round checks the remaining keys once,
+    /// rounds roughly double interval length, so a key set much denser than needed costs a few passes. Intervals are checked in parallel over params.threads.
+    /// Extracted keys are within tolerance, but may differ from from_gradient with Approximate: merging is greedy
+    /// and never moves a previous key, so it can keep more keys than Approximate extracts.
+    /// @param original Original gradient data
+    /// @param previous Previous keys including both ends, positions in original's range (before Builder::transform)
+    /// @param params Tolerance and threads
+    /// @param builder Output range
+    template<typename DistanceOp, LinearData TGradient>
+    [[nodiscard]] TGradient refine(TGradient& original, const TGradient& previous, const Refine& params = {}, const Builder<TGradient>& builder = {}) {
+        ITG_TRACE_ZONE("refine");
+
+        if (std::empty(original))
+            return {};
+
+        const size_t size = std::size(original);
+        auto section = [&](size_t first, size_t last) {
+            return std::ranges::subrange(std::begin(original) + first, std::begin(original) + last + 1);
+        };
+        auto distance = [&](size_t first, size_t last) {
+            auto range = section(first, last);
+            return Strategy::FindFarthest<decltype(range)>{}(range, DistanceOp{}).second;
+        };
+
+        // Interval ends. First and last previous key stand for original's ends, as from_gradient adds them.
+        std::vector<size_t> ends{ 0 };
+        for (size_t i = 1; i + 1 < std::size(previous); i++) {
+            const size_t index = Detail::find_key(original, previous[i]);
+            if (index > ends.back() && index < size - 1)
+                ends.push_back(index);
+        }
+        ends.push_back(size - 1);
+        const size_t intervals = ends.size() - 1;
+
+        // Verification pass
+        std::vector<float> distances(intervals);
+        Detail::parallel_for(intervals, params, [&](size_t s) {
+            distances[s] = distance(ends[s], ends[s + 1]);
+        });
+
+        // Adjacent intervals within tolerance are merged if their shared key can be dropped. Each round pairs intervals (2j + offset, 2j + 1 + offset),
+        // pairs don't overlap and are independent. Offset alternates and rounds repeat until neither pairing drops a key.
+        // Shared key that can't be dropped is blocked until one of its intervals is merged with another one.
+        std::vector<char> blocked(ends.size(), 0);
+        std::vector<char> merged;
+        std::vector<float> merged_distances;
+        for (size_t round = 0, idle_rounds = 0; idle_rounds < 2 && ends.size() > 2; round++) {
+            const size_t offset = round % 2;
+            const size_t pairs = (ends.size() - 1 - offset) / 2;
+
+            merged.assign(pairs, 0);
+            merged_distances.resize(pairs);
+            Detail::parallel_for(pairs, params, [&](size_t j) {
+                const size_t s = 2 * j + offset;
+                if (blocked[s + 1] || !(distances[s] <= params.tolerance) || !(distances[s + 1] <= params.tolerance))
+                    return;
+                merged_distances[j] = distance(ends[s], ends[s + 2]);
+                merged[j] = merged_distances[j] <= params.tolerance;
+                blocked[s + 1] = !merged[j];
+            });
+
+            if (std::ranges::find(merged, 1) == std::end(merged)) {
+                idle_rounds++;
+                continue;
+            }
+            idle_rounds = 0;
+
+            // Drop shared keys of merged pairs, keys around a merged interval may be droppable now
+            size_t kept = 1;
+            for (size_t s = 0; s + 1 < ends.size(); s++) {
+                const bool pair_first = s >= offset && (s - offset) % 2 == 0 && (s - offset) / 2 < pairs;
+                if (pair_first && merged[(s - offset) / 2]) {
+                    distances[kept - 1] = merged_distances[(s - offset) / 2];
+                    blocked[kept - 1] = 0;
+                    ends[kept] = ends[s + 2];
+                    blocked[kept] = 0;
+                    kept++;
+                    s++;
+                } else {
+                    distances[kept - 1] = distances[s];
+                    ends[kept] = ends[s + 1];
+                    blocked[kept] = blocked[s + 1];
+                    kept++;
+                }
+            }
+            ends.resize(kept);
+            blocked.resize(kept);
+            distances.resize(kept - 1);
+        }
+        const size_t merged_intervals = ends.size() - 1;
+
+        // Violating intervals are split, independently of each other
+        std::vector<TGradient> splits(merged_intervals);
+        Detail::parallel_for(merged_intervals, params, [&](size_t s) {
+            if (!(distances[s] <= params.tolerance))
+                Strategy::Approximate{ .tolerance = params.tolerance }(section(ends[s], ends[s + 1]), splits[s], DistanceOp{});
+        });
+
+        TGradient keys;
+        keys.push_back(original[0]);
+        for (size_t s = 0; s < merged_intervals; s++) {
+            for (const auto& key : splits[s])
+                keys.push_back(key);
+            if (s + 1 < merged_intervals)
+                keys.push_back(original[ends[s + 1]]);
+        }
+        keys.push_back(original[size - 1]);
+
+        return builder.build(std::move(keys));
+    }
+
+}
@@ -0,0 +1,185 @@
+﻿#pragma once
+
+#include <concepts>
+#include <cstring>
+#include <memory>
+#include <ranges>
+#include <type_traits>
+#include <vector>
+
+#include "gradient/linear.hpp"
+#include "gradient/builder.hpp"
+#include "gradient/strategy/find_farthest.hpp"
+
+namespace ItG::Gradient {
+
+    /// @brief Strategy with a tolerance target, section within tolerance needs no keys
+    template<typename Strategy>
+    concept ToleranceStrategy = requires (const Strategy & strategy) { { strategy.tolerance } -> std::convertible_to<float>; };
+
+    /// @brief Fit the same line of consecutive frames, reusing keys of the previous frame.
+    /// Frame is compared with the previous one section by section, sections between previous keys whose keys are unchanged keep their keys.
+    /// Changed sections are kept if they are still within tolerance and refitted with strategy otherwise.
+    /// Unchanged frame costs a comparison of key memory. Frames of different size or mostly changed frames are fitted from scratch.
+    /// Keys are within tolerance but may differ from from_gradient with the same strategy once a frame is refitted partially.
+    /// Strategy has to extract keys of the original gradient, as all strategies here do.
+    /// Not thread safe, use one sequence per line.
+    template<typename DistanceOp, ToleranceStrategy Strategy, LinearData TGradient>
+    class Sequence {
+    public:
+        /// @brief How frame was fitted
+        enum class Change {
+            /// Same keys as previous frame, nothing fitted
+            Unchanged,
+            /// Changed sections verified or refitted
+            Partial,
+            /// Fitted from scratch
+            Full
+        };
+
+        /// @brief Fit from scratch when more than this fraction of keys is in changed sections
+        float full_refit = 0.5f;
+
+        explicit Sequence(Strategy strategy = {}, Builder<TGradient> builder = {}) : strategy(std::move(strategy)), builder(builder) {}
+
+        /// @brief Extract keys of next frame into reusable output, as from_gradient_into
+        /// @param frame Keys of the line in next frame
+        /// @param output Previous content is replaced, capacity is reused
+        Change operator()(const TGradient& frame, TGradient& output) {
+            ITG_TRACE_ZONE("Sequence");
+
+            const Change change = update(frame);
+
+            output.clear();
+            for (size_t index : indices)
+                output.emplace_back(previous[index]);
+            builder.transform(output);
+            return change;
+        }
+
+        /// @brief Forget previous frame, next frame is fitted from scratch
+        void reset() {
+            previous.clear();
+            indices.clear();
+        }
+
+    private:
+        using Value = LinearRange_Value<TGradient>;
+
+        /// @brief Keys first..last of frame are bitwise equal to previous frame, no key of an equal section can fit differently
+        bool same(const TGradient& frame, size_t first, size_t last) const {
+            if constexpr (std::ranges::contiguous_range<TGradient> && std::is_trivially_copyable_v<Value>) {
+                return std::memcmp(std::data(frame) + first, std::data(previous) + first, (last - first) * sizeof(Value)) == 0;
+            } else {
+                for (size_t i = first; i < last; i++) {
+                    if (!(frame[i] == previous[i]))
+                        return false;
+                }
+                return true;
+            }
+        }
+
+        Change update(const TGradient& frame) {
+            const size_t size = std::size(frame);
+            if (size == 0) {
+                reset();
+                return Change::Full;
+            }
+
+            if (indices.empty() || size != std::size(previous))
+                return fit(frame);
+
+            if (same(frame, 0, size))
+                return Change::Unchanged;
+
+            // Sections share their end keys, a changed end key changes both sections
+            changed.clear();
+            size_t changed_keys = 0;
+            for (size_t s = 0; s + 1 < indices.size(); s++) {
+                const bool section_changed = !same(frame, indices[s], indices[s + 1] + 1);
+                changed.push_back(section_changed);
+                if (section_changed)
+                    changed_keys += indices[s + 1] - indices[s] + 1;
+            }
+
+            if (float(changed_keys) > full_refit * float(size))
+                return fit(frame);
+
+            next.clear();
+            next.push_back(indices.front());
+            for (size_t s = 0; s + 1 < indices.size(); s++) {
+                const size_t first = indices[s], last = indices[s + 1];
+                if (changed[s]) {
+                    replace(frame, first, last + 1);
+                    refit(first, last, false);
+                }
+                next.push_back(last);
+            }
+            std::swap(indices, next);
+            return Change::Partial;
+        }
+
+        /// @brief Fit whole frame from scratch
+        Change fit(const TGradient& frame) {
+            previous.clear();
+            for (const auto& key : frame)
+                previous.emplace_back(key);
+
+            next.clear();
+            next.push_back(0);
+            refit(0, std::size(previous) - 1, true);
+            next.push_back(std::size(previous) - 1);
+            std::swap(indices, next);
+            return Change::Full;
+        }
+
+        /// @brief Copy keys first..last of frame over previous frame. Keys are not assignable, replace in place.
+        void replace(const TGradient& frame, size_t first, size_t last) {
+            for (size_t i = first; i < last; i++) {
+                Value* slot = &previous[i];
+                std::destroy_at(slot);
+                std::construct_at(slot, frame[i]);
+            }
+        }
+
+        /// @brief Append indices of keys strategy extracts between first and last to next.
+        /// Section within tolerance keeps no inner keys, unless forced.
+        void refit(size_t first, size_t last, bool force) {
+            auto section = std::ranges::subrange(std::begin(previous) + first, std::begin(previous) + last + 1);
+
+            if (!force) {
+                auto [farthest, distance] = Gradient::Strategy::FindFarthest<decltype(section)>{}(section, DistanceOp{});
+                if (distance <= strategy.tolerance)
+                    return;
+            }
+
+            extracted.clear();
+            strategy(section, extracted, DistanceOp{});
+
+            // Extracted keys are copies of keys in order, find their indices
+            size_t cursor = first + 1;
+            for (const auto& key : extracted) {
+                while (cursor < last && !(previous[cursor] == key))
+                    cursor++;
+                if (cursor >= last)
+                    break;
+                next.push_back(cursor++);
+            }
+        }
+
+        Strategy strategy;
+        Builder<TGradient> builder;
+
+        /// Keys of previous frame
+        TGradient previous;
+        /// Indices of extracted keys in previous frame
+        std::vector<size_t> indices;
+        /// Indices of extracted keys being built
+        std::vector<size_t> next;
+        /// Sections of previous keys with changed keys
+        std::vector<bool> changed;
+        /// Strategy output of a section
+        TGradient extracted;
+    };
+
+}
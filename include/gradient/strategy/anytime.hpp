@@ -0,0 +1,114 @@
+﻿#pragma once
+
+#include <chrono>
+#include <limits>
+#include <map>
+#include <queue>
+#include <ranges>
+#include <vector>
+
+#include "gradient/linear.hpp"
+#include "gradient/strategy/find_farthest.hpp"
+
+namespace ItG::Gradient::Strategy {
+
+    /// @brief Outcome of an Anytime extraction
+    struct AnytimeReport {
+        /// @brief Maximal distance between extracted and original gradient. Not greater than tolerance if complete.
+        float tolerance = 0.f;
+        /// @brief Number of distance evaluations performed
+        size_t evaluations = 0;
+        /// @brief Requested tolerance was reached before deadline or work budget
+        bool complete = false;
+    };
+
+    /// @brief Extract keys that are close enough to original gradient, most significant first.
+    /// Can be stopped by deadline or work budget, extracted gradient is then coarser than requested.
+    /// Produces the same keys as Approximate when not stopped early.
+    /// @tparam OnKey Callable invoked as on_key(key, distance) for each key when it's extracted,
+    /// keys are delivered in order of significance.
+    template<typename OnKey = std::nullptr_t>
+    struct Anytime {
+        using Clock = std::chrono::steady_clock;
+
+        /// @brief Maximal distance between extracted end original gradient.
+        float tolerance = 4.f / 255.f;
+        /// @brief Stop extraction at this time point.
+        Clock::time_point deadline = Clock::time_point::max();
+        /// @brief Stop extraction after this number of distance evaluations.
+        size_t max_evaluations = std::numeric_limits<size_t>::max();
+        /// @brief Callback for progressive output, optional.
+        OnKey on_key{};
+        /// @brief Receives outcome of extraction, optional.
+        AnytimeReport* report = nullptr;
+
+        /// @brief Extract keys from original range.
+        /// @param original Original gradient data (full gradient or sub-section)
+        /// @param extracted Output gradient data (extracted values are appended at end)
+        /// @param distance_op Operator for calculating distance
+        template<LinearRange Range>
+        void operator()(Range original, LinearData auto& extracted, auto&& distance_op) const {
+            using namespace std;
+
+            using Iterator = LinearRange_Iterator<Range>;
+            using Span = LinearRange_Subrange<Range>;
+
+            struct Pending {
+                float distance;
+                Iterator fartherst;
+                Span span;
+
+                bool operator<(const Pending& other) const { return distance < other.distance; }
+            };
+            ITG_TRACE_ZONE("Anytime");
+
+            /// Unprocessed sub-gradients, most distant first
+            priority_queue<Pending> pending;
+
+            // Extracted keys, by order in original array to support banding.
+            map<ptrdiff_t, Iterator> splits;
+
+            FindFarthest<Range> find_farthest;
+            size_t evaluations = 0;
+            // Biggest distance of sub-gradients that are already close enough
+            float reached = 0.f;
+
+            auto push = [&](Span span) {
+                evaluations += size(span);
+                auto [fartherst, distance] = find_farthest(span, forward<decltype(distance_op)>(distance_op));
+                if (distance > tolerance)
+                    pending.push({ distance, fartherst, span });
+                else
+                    reached = max(reached, distance);
+            };
+
+            push(Span(begin(original), end(original)));
+
+            while (!pending.empty() && evaluations < max_evaluations && Clock::now() < deadline) {
+                Pending current = pending.top();
+                pending.pop();
+
+                splits.emplace(std::distance(begin(original), current.fartherst), current.fartherst);
+                if constexpr (!is_null_pointer_v<OnKey>) {
+                    on_key(*current.fartherst, current.distance);
+                }
+
+                push(Span(begin(current.span), next(current.fartherst)));
+                push(Span(current.fartherst, end(current.span)));
+            }
+
+            if (report) {
+                report->tolerance = pending.empty() ? reached : max(reached, pending.top().distance);
+                report->evaluations = evaluations;
+                report->complete = pending.empty();
+            }
+
+            /// Build extracted gradient
+            for (auto& split : views::values(splits)) {
+                extracted.emplace_back(*split);
+            }
+        }
+
+    };
+
+}
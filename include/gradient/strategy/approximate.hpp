@@ -28,6 +28,7 @@ namespace ItG::Gradient::Strategy {
             using Iterator = LinearRange_Iterator<Range>;
             using Span = LinearRange_Subrange<Range>;
             using SpanStack = std::stack< Span >;
+            ITG_TRACE_ZONE("Approximate");
 
             /// Stack with unprocessed sub-gradients
             SpanStack pending;
@@ -76,7 +77,6 @@ namespace ItG::Gradient::Strategy {
         void operator()(Range range, LinearData auto& splits, auto&& distance_op) const {
             using namespace std;
 
-            using Iterator = Range::iterator;
             FindFarthest<Range> find_farthest;
 
             auto [fartherst, distance] = find_farthest(range, forward<decltype(distance_op)>(distance_op));
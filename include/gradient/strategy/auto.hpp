@@ -0,0 +1,200 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <string_view>
+
+#include "gradient/linear.hpp"
+#include "gradient/evaluate.hpp"
+#include "gradient/strategy/approximate.hpp"
+#include "gradient/strategy/collapse.hpp"
+#include "gradient/strategy/step_count.hpp"
+#include "gradient/strategy/auto_costs.hpp"
+
+namespace ItG::Gradient::Strategy {
+
+    /// @brief Implementations Auto chooses from.
+    /// Kernels for the same quality target extract the same keys.
+    enum class Kernel : uint8_t {
+        /// Tolerance target
+        Approximate,
+        ApproximateRecurse,
+        CollapsedApproximate,
+        /// Key count target
+        ColorCount,
+        CollapsedColorCount
+    };
+
+    constexpr size_t kernel_count = 5;
+
+    constexpr std::array<std::string_view, kernel_count> kernel_names{
+        "Approximate", "ApproximateRecurse", "Collapsed<Approximate>", "ColorCount", "Collapsed<ColorCount>"
+    };
+
+    /// @brief Input features that decide which kernel is fastest
+    struct Profile {
+        /// @brief Number of keys
+        size_t length = 0;
+        /// @brief Number of color channels
+        size_t channels = 0;
+        /// @brief Fraction of keys equal to their predecessor, the part Collapsed removes
+        float run_ratio = 0.f;
+        /// @brief Mean squared second difference of channels, variance of noise around a piecewise linear line.
+        /// Noisy lines need more keys and deeper splitting.
+        float variance = 0.f;
+    };
+
+    /// @brief Estimate profile from evenly spaced triples of neighbouring keys
+    /// @param samples Maximal number of triples inspected, cost doesn't grow with range size
+    template<LinearRange Range>
+    [[nodiscard]] Profile profile(Range range, size_t samples = 128) {
+        using Value = LinearRange_Value<Range>;
+        constexpr size_t Size = Value::size;
+
+        Profile result{ .length = static_cast<size_t>(std::size(range)), .channels = Size };
+        if (result.length < 3 || samples == 0)
+            return result;
+
+        const size_t triples = result.length - 2;
+        const size_t stride = std::max<size_t>(1, triples / samples);
+
+        size_t inspected = 0, repeated = 0;
+        double squares = 0.;
+        for (size_t i = 0; i < triples; i += stride) {
+            const auto previous = std::next(std::begin(range), i);
+            const auto key = std::next(previous);
+            const auto following = std::next(key);
+
+            bool same = true;
+            for (size_t c = 0; c < Size; c++) {
+                const float value = Detail::channel(key->color, c);
+                const float second = Detail::channel(following->color, c) - 2.f * value + Detail::channel(previous->color, c);
+                same = same && value == Detail::channel(previous->color, c);
+                squares += double(second) * second;
+            }
+            repeated += same;
+            inspected++;
+        }
+
+        result.run_ratio = float(repeated) / inspected;
+        result.variance = float(squares / (double(inspected) * Size));
+        return result;
+    }
+
+    /// @brief Measured cost of every kernel for classes of input profiles.
+    /// Profiles are bucketed by channel count, length, run ratio and variance,
+    /// each bucket has a representative the calibration measures.
+    struct CostTable {
+        static constexpr std::array<size_t, 3> channels{ 1, 3, 4 };
+        static constexpr std::array<size_t, 5> lengths{ 32, 128, 512, 2048, 8192 };
+        static constexpr std::array<float, 3> run_ratios{ 0.f, 0.5f, 0.9f };
+        /// Smooth and noisy lines
+        static constexpr std::array<float, 2> variances{ 0.f, 2e-3f };
+        static constexpr size_t cell_count = channels.size() * lengths.size() * run_ratios.size() * variances.size();
+
+        using Cell = std::array<float, kernel_count>;
+
+        /// @brief Nanoseconds per gradient, [channels][length][run ratio][variance][kernel]
+        std::array<Cell, cell_count> costs;
+
+        /// @brief Bucket of value, buckets are split halfway between representatives (geometrically for lengths)
+        template<typename T, size_t N>
+        [[nodiscard]] static size_t bucket(const std::array<T, N>& representatives, double value, bool geometric = false) {
+            for (size_t i = 0; i + 1 < N; i++) {
+                const double bound = geometric
+                    ? std::sqrt(double(representatives[i]) * double(representatives[i + 1]))
+                    : (double(representatives[i]) + double(representatives[i + 1])) / 2.;
+                if (value < bound)
+                    return i;
+            }
+            return N - 1;
+        }
+
+        [[nodiscard]] static size_t cell(size_t channel_index, size_t length_index, size_t run_index, size_t variance_index) {
+            return ((channel_index * lengths.size() + length_index) * run_ratios.size() + run_index) * variances.size() + variance_index;
+        }
+
+        [[nodiscard]] static size_t cell(const Profile& profile) {
+            return cell(
+                bucket(channels, double(profile.channels)),
+                bucket(lengths, double(profile.length), true),
+                bucket(run_ratios, profile.run_ratio),
+                bucket(variances, profile.variance)
+            );
+        }
+
+        /// @brief Cheapest kernel for the quality target
+        /// @param count_target Key count target if true, tolerance target otherwise
+        [[nodiscard]] Kernel select(const Profile& profile, bool count_target) const {
+            const Cell& cost = costs[cell(profile)];
+            if (count_target)
+                return cost[size_t(Kernel::CollapsedColorCount)] < cost[size_t(Kernel::ColorCount)] ? Kernel::CollapsedColorCount : Kernel::ColorCount;
+
+            Kernel best = Kernel::Approximate;
+            for (Kernel kernel : { Kernel::ApproximateRecurse, Kernel::CollapsedApproximate }) {
+                if (cost[size_t(kernel)] < cost[size_t(best)])
+                    best = kernel;
+            }
+            return best;
+        }
+    };
+
+    /// @brief Costs measured by itg-calibrate, see auto_costs.hpp
+    inline constexpr CostTable calibrated_costs{ Calibration::costs };
+
+    /// @brief Pick the fastest kernel for the input and quality target.
+    /// Input is profiled from a few key triples, its profile selects the cheapest kernel in a calibrated cost table.
+    /// Extracted keys are the same as with the selected kernel's reference: Approximate, or ColorCount with count target.
+    struct Auto {
+        /// @brief Maximal distance between extracted end original gradient, used without count target.
+        float tolerance = 4.f / 255.f;
+        /// @brief Target number of keys, as ColorCount. Tolerance target if 0.
+        size_t count = 0;
+        /// @brief Kernel costs, regenerate with itg-calibrate on target machine
+        const CostTable* costs = &calibrated_costs;
+        /// @brief Run this kernel instead of selecting one, for calibration and tests
+        std::optional<Kernel> kernel{};
+
+        /// @brief Kernel that extracts range
+        template<LinearRange Range>
+        [[nodiscard]] Kernel select(Range range) const {
+            if (kernel)
+                return *kernel;
+            return costs->select(profile(range), count > 0);
+        }
+
+        /// @brief Extract keys from original range.
+        /// @param original Original gradient data (full gradient or sub-section)
+        /// @param extracted Output gradient data (extracted values are appended at end)
+        /// @param distance_op Operator for calculating distance
+        template<LinearRange Range>
+        void operator()(Range original, LinearData auto& extracted, auto&& distance_op) const {
+            ITG_TRACE_ZONE("Auto");
+
+            auto&& op = std::forward<decltype(distance_op)>(distance_op);
+            switch (select(original)) {
+            case Kernel::Approximate:
+                Approximate{ .tolerance = tolerance }(original, extracted, op);
+                break;
+            case Kernel::ApproximateRecurse:
+                ApproximateRecurse{ .tolerance = tolerance }(original, extracted, op);
+                break;
+            case Kernel::CollapsedApproximate:
+                Collapsed<Approximate>{ .inner = { .tolerance = tolerance } }(original, extracted, op);
+                break;
+            case Kernel::ColorCount:
+                ColorCount{ .count = count }(original, extracted, op);
+                break;
+            case Kernel::CollapsedColorCount:
+                Collapsed<ColorCount>{ .inner = { .count = count } }(original, extracted, op);
+                break;
+            }
+        }
+
+    };
+
+}
@@ -0,0 +1,195 @@
+﻿#pragma once
+
+#include <array>
+
+// Generated by itg-calibrate, regenerate on target machine:
+//     itg-calibrate --output include/gradient/strategy/auto_costs.hpp
+
+namespace ItG::Gradient::Strategy::Calibration {
+
+    /// @brief Nanoseconds per gradient of Approximate, ApproximateRecurse, Collapsed<Approximate>, ColorCount, Collapsed<ColorCount>,
+    /// by [channels][length][run ratio][variance], see CostTable
+    inline constexpr std::array<std::array<float, 5>, 90> costs{ {
+        // 1 channels, 32 keys, run ratio 0, variance 0
+        { 2269.f, 1845.f, 1222.f, 3349.f, 3914.f },
+        // 1 channels, 32 keys, run ratio 0, variance 0.002
+        { 2130.f, 1876.f, 2861.f, 5266.f, 8631.f },
+        // 1 channels, 32 keys, run ratio 0.5, variance 0
+        { 2150.f, 1146.f, 1923.f, 4487.f, 3926.f },
+        // 1 channels, 32 keys, run ratio 0.5, variance 0.002
+        { 1981.f, 1403.f, 2353.f, 4145.f, 3882.f },
+        // 1 channels, 32 keys, run ratio 0.9, variance 0
+        { 900.f, 1679.f, 1597.f, 8757.f, 3799.f },
+        // 1 channels, 32 keys, run ratio 0.9, variance 0.002
+        { 1823.f, 1546.f, 1115.f, 6626.f, 3231.f },
+        // 1 channels, 128 keys, run ratio 0, variance 0
+        { 7500.f, 7287.f, 7247.f, 22735.f, 25002.f },
+        // 1 channels, 128 keys, run ratio 0, variance 0.002
+        { 77022.f, 32117.f, 33375.f, 25657.f, 24638.f },
+        // 1 channels, 128 keys, run ratio 0.5, variance 0
+        { 15877.f, 12829.f, 15123.f, 28955.f, 23741.f },
+        // 1 channels, 128 keys, run ratio 0.5, variance 0.002
+        { 26300.f, 17827.f, 33673.f, 36728.f, 25405.f },
+        // 1 channels, 128 keys, run ratio 0.9, variance 0
+        { 10540.f, 9715.f, 4677.f, 30195.f, 10222.f },
+        // 1 channels, 128 keys, run ratio 0.9, variance 0.002
+        { 13273.f, 10481.f, 6271.f, 29471.f, 17139.f },
+        // 1 channels, 512 keys, run ratio 0, variance 0
+        { 25294.f, 24900.f, 26294.f, 94201.f, 108814.f },
+        // 1 channels, 512 keys, run ratio 0, variance 0.002
+        { 188033.f, 116664.f, 220202.f, 106374.f, 117675.f },
+        // 1 channels, 512 keys, run ratio 0.5, variance 0
+        { 50155.f, 40838.f, 39286.f, 84458.f, 71233.f },
+        // 1 channels, 512 keys, run ratio 0.5, variance 0.002
+        { 133767.f, 95080.f, 159943.f, 116609.f, 98182.f },
+        // 1 channels, 512 keys, run ratio 0.9, variance 0
+        { 49077.f, 54260.f, 22099.f, 47720.f, 10571.f },
+        // 1 channels, 512 keys, run ratio 0.9, variance 0.002
+        { 32536.f, 28289.f, 12875.f, 51722.f, 12106.f },
+        // 1 channels, 2048 keys, run ratio 0, variance 0
+        { 46480.f, 45216.f, 51512.f, 203622.f, 206681.f },
+        // 1 channels, 2048 keys, run ratio 0, variance 0.002
+        { 608753.f, 396163.f, 512124.f, 204956.f, 209951.f },
+        // 1 channels, 2048 keys, run ratio 0.5, variance 0
+        { 44424.f, 45002.f, 62073.f, 249717.f, 226195.f },
+        // 1 channels, 2048 keys, run ratio 0.5, variance 0.002
+        { 390735.f, 261719.f, 707374.f, 210336.f, 156919.f },
+        // 1 channels, 2048 keys, run ratio 0.9, variance 0
+        { 83025.f, 78400.f, 24855.f, 200878.f, 45927.f },
+        // 1 channels, 2048 keys, run ratio 0.9, variance 0.002
+        { 185133.f, 156783.f, 80482.f, 201294.f, 50065.f },
+        // 1 channels, 8192 keys, run ratio 0, variance 0
+        { 240822.f, 258230.f, 316729.f, 823333.f, 932188.f },
+        // 1 channels, 8192 keys, run ratio 0, variance 0.002
+        { 4047687.f, 2001218.f, 2937602.f, 816417.f, 850019.f },
+        // 1 channels, 8192 keys, run ratio 0.5, variance 0
+        { 189089.f, 187648.f, 235196.f, 791128.f, 728472.f },
+        // 1 channels, 8192 keys, run ratio 0.5, variance 0.002
+        { 2261778.f, 1887495.f, 1923958.f, 827045.f, 715274.f },
+        // 1 channels, 8192 keys, run ratio 0.9, variance 0
+        { 220152.f, 248155.f, 76984.f, 922998.f, 181025.f },
+        // 1 channels, 8192 keys, run ratio 0.9, variance 0.002
+        { 1104923.f, 1178184.f, 458341.f, 788978.f, 169873.f },
+        // 3 channels, 32 keys, run ratio 0, variance 0
+        { 1988.f, 1708.f, 2424.f, 7109.f, 9633.f },
+        // 3 channels, 32 keys, run ratio 0, variance 0.002
+        { 7030.f, 3597.f, 5123.f, 6534.f, 6700.f },
+        // 3 channels, 32 keys, run ratio 0.5, variance 0
+        { 3971.f, 4620.f, 7245.f, 18519.f, 13764.f },
+        // 3 channels, 32 keys, run ratio 0.5, variance 0.002
+        { 5200.f, 3900.f, 4576.f, 9533.f, 8416.f },
+        // 3 channels, 32 keys, run ratio 0.9, variance 0
+        { 2494.f, 1581.f, 1586.f, 8420.f, 3265.f },
+        // 3 channels, 32 keys, run ratio 0.9, variance 0.002
+        { 1679.f, 1551.f, 1330.f, 9830.f, 3353.f },
+        // 3 channels, 128 keys, run ratio 0, variance 0
+        { 7846.f, 7151.f, 8675.f, 25970.f, 29578.f },
+        // 3 channels, 128 keys, run ratio 0, variance 0.002
+        { 54688.f, 44722.f, 70756.f, 31252.f, 34869.f },
+        // 3 channels, 128 keys, run ratio 0.5, variance 0
+        { 42689.f, 26091.f, 27433.f, 30279.f, 27512.f },
+        // 3 channels, 128 keys, run ratio 0.5, variance 0.002
+        { 34108.f, 25407.f, 43432.f, 33743.f, 26153.f },
+        // 3 channels, 128 keys, run ratio 0.9, variance 0
+        { 10983.f, 8873.f, 6849.f, 27797.f, 7924.f },
+        // 3 channels, 128 keys, run ratio 0.9, variance 0.002
+        { 12743.f, 9399.f, 3815.f, 21760.f, 5832.f },
+        // 3 channels, 512 keys, run ratio 0, variance 0
+        { 16576.f, 18223.f, 26877.f, 128695.f, 195159.f },
+        // 3 channels, 512 keys, run ratio 0, variance 0.002
+        { 450826.f, 162750.f, 272922.f, 93000.f, 96515.f },
+        // 3 channels, 512 keys, run ratio 0.5, variance 0
+        { 57587.f, 47847.f, 45740.f, 86437.f, 70120.f },
+        // 3 channels, 512 keys, run ratio 0.5, variance 0.002
+        { 187080.f, 144852.f, 212708.f, 127484.f, 93307.f },
+        // 3 channels, 512 keys, run ratio 0.9, variance 0
+        { 58577.f, 48780.f, 28203.f, 86481.f, 20864.f },
+        // 3 channels, 512 keys, run ratio 0.9, variance 0.002
+        { 150936.f, 63278.f, 29898.f, 83443.f, 20743.f },
+        // 3 channels, 2048 keys, run ratio 0, variance 0
+        { 78957.f, 72379.f, 75441.f, 302597.f, 337422.f },
+        // 3 channels, 2048 keys, run ratio 0, variance 0.002
+        { 972685.f, 706490.f, 1161650.f, 410708.f, 334311.f },
+        // 3 channels, 2048 keys, run ratio 0.5, variance 0
+        { 78827.f, 75586.f, 76628.f, 357793.f, 733614.f },
+        // 3 channels, 2048 keys, run ratio 0.5, variance 0.002
+        { 739234.f, 545085.f, 794574.f, 308705.f, 270972.f },
+        // 3 channels, 2048 keys, run ratio 0.9, variance 0
+        { 225846.f, 209864.f, 67669.f, 334649.f, 77353.f },
+        // 3 channels, 2048 keys, run ratio 0.9, variance 0.002
+        { 352423.f, 418984.f, 184565.f, 320478.f, 69204.f },
+        // 3 channels, 8192 keys, run ratio 0, variance 0
+        { 278771.f, 285272.f, 413217.f, 1196832.f, 1401172.f },
+        // 3 channels, 8192 keys, run ratio 0, variance 0.002
+        { 4727380.f, 3586271.f, 5024317.f, 1232925.f, 1275645.f },
+        // 3 channels, 8192 keys, run ratio 0.5, variance 0
+        { 315282.f, 305413.f, 356339.f, 1567040.f, 1389673.f },
+        // 3 channels, 8192 keys, run ratio 0.5, variance 0.002
+        { 4178426.f, 3533141.f, 3377172.f, 1251890.f, 1070354.f },
+        // 3 channels, 8192 keys, run ratio 0.9, variance 0
+        { 487683.f, 607839.f, 125749.f, 1208664.f, 282707.f },
+        // 3 channels, 8192 keys, run ratio 0.9, variance 0.002
+        { 1799546.f, 1765659.f, 849109.f, 1549880.f, 304818.f },
+        // 4 channels, 32 keys, run ratio 0, variance 0
+        { 3051.f, 2054.f, 2319.f, 7563.f, 8084.f },
+        // 4 channels, 32 keys, run ratio 0, variance 0.002
+        { 5716.f, 4038.f, 6047.f, 8639.f, 8733.f },
+        // 4 channels, 32 keys, run ratio 0.5, variance 0
+        { 4027.f, 3257.f, 4041.f, 8581.f, 9605.f },
+        // 4 channels, 32 keys, run ratio 0.5, variance 0.002
+        { 5781.f, 3604.f, 4008.f, 8303.f, 6933.f },
+        // 4 channels, 32 keys, run ratio 0.9, variance 0
+        { 1840.f, 1612.f, 1238.f, 22836.f, 3251.f },
+        // 4 channels, 32 keys, run ratio 0.9, variance 0.002
+        { 1934.f, 1831.f, 1335.f, 7581.f, 2594.f },
+        // 4 channels, 128 keys, run ratio 0, variance 0
+        { 5935.f, 5890.f, 7237.f, 28985.f, 29743.f },
+        // 4 channels, 128 keys, run ratio 0, variance 0.002
+        { 47475.f, 32983.f, 67122.f, 37036.f, 36797.f },
+        // 4 channels, 128 keys, run ratio 0.5, variance 0
+        { 33791.f, 25643.f, 35556.f, 42726.f, 42701.f },
+        // 4 channels, 128 keys, run ratio 0.5, variance 0.002
+        { 94420.f, 31709.f, 50770.f, 37588.f, 36829.f },
+        // 4 channels, 128 keys, run ratio 0.9, variance 0
+        { 20714.f, 16822.f, 8382.f, 36508.f, 8105.f },
+        // 4 channels, 128 keys, run ratio 0.9, variance 0.002
+        { 12757.f, 11662.f, 5690.f, 39553.f, 9812.f },
+        // 4 channels, 512 keys, run ratio 0, variance 0
+        { 28844.f, 22264.f, 24149.f, 109985.f, 117094.f },
+        // 4 channels, 512 keys, run ratio 0, variance 0.002
+        { 656415.f, 211465.f, 245600.f, 109833.f, 109254.f },
+        // 4 channels, 512 keys, run ratio 0.5, variance 0
+        { 63031.f, 71358.f, 64468.f, 112419.f, 89798.f },
+        // 4 channels, 512 keys, run ratio 0.5, variance 0.002
+        { 195156.f, 139053.f, 189137.f, 138107.f, 114670.f },
+        // 4 channels, 512 keys, run ratio 0.9, variance 0
+        { 75507.f, 63167.f, 30022.f, 111765.f, 24755.f },
+        // 4 channels, 512 keys, run ratio 0.9, variance 0.002
+        { 92173.f, 81675.f, 45435.f, 114049.f, 25843.f },
+        // 4 channels, 2048 keys, run ratio 0, variance 0
+        { 209021.f, 108307.f, 90689.f, 431206.f, 420078.f },
+        // 4 channels, 2048 keys, run ratio 0, variance 0.002
+        { 1233991.f, 943740.f, 1257250.f, 392007.f, 421324.f },
+        // 4 channels, 2048 keys, run ratio 0.5, variance 0
+        { 106735.f, 108292.f, 133180.f, 592394.f, 333741.f },
+        // 4 channels, 2048 keys, run ratio 0.5, variance 0.002
+        { 968870.f, 747150.f, 848312.f, 472312.f, 445805.f },
+        // 4 channels, 2048 keys, run ratio 0.9, variance 0
+        { 374450.f, 283426.f, 157958.f, 630814.f, 88853.f },
+        // 4 channels, 2048 keys, run ratio 0.9, variance 0.002
+        { 435642.f, 369444.f, 188037.f, 426902.f, 95915.f },
+        // 4 channels, 8192 keys, run ratio 0, variance 0
+        { 574884.f, 533525.f, 700794.f, 2154208.f, 2456779.f },
+        // 4 channels, 8192 keys, run ratio 0, variance 0.002
+        { 9865995.f, 5777451.f, 6858156.f, 1720269.f, 1871750.f },
+        // 4 channels, 8192 keys, run ratio 0.5, variance 0
+        { 579482.f, 508381.f, 455154.f, 1736524.f, 1453324.f },
+        // 4 channels, 8192 keys, run ratio 0.5, variance 0.002
+        { 6358052.f, 4227502.f, 4605978.f, 1956056.f, 1400433.f },
+        // 4 channels, 8192 keys, run ratio 0.9, variance 0
+        { 551511.f, 522298.f, 185501.f, 2183108.f, 340764.f },
+        // 4 channels, 8192 keys, run ratio 0.9, variance 0.002
+        { 2451660.f, 2301110.f, 1846548.f, 1543645.f, 365857.f },
+    } };
+
+}
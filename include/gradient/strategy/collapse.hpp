@@ -0,0 +1,82 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <ranges>
+#include <vector>
+
+#include "gradient/linear.hpp"
+#include "gradient/evaluate.hpp"
+#include "gradient/strategy/approximate.hpp"
+
+namespace ItG::Gradient::Strategy {
+
+    /// @brief Run inner strategy on gradient with runs of identical colors collapsed to their first and last key.
+    /// Keys inside a run never deviate more than run ends, so hard band edges are kept and
+    /// with zero epsilon the result matches inner strategy on full gradient.
+    /// Extracted keys are the original keys at their exact positions.
+    /// @tparam Inner Strategy used on collapsed gradient
+    template<typename Inner = Approximate>
+    struct Collapsed {
+        /// @brief Strategy used on collapsed gradient
+        Inner inner{};
+        /// @brief Maximal channel difference to first key of a run for key to be part of the run
+        float epsilon = 0.f;
+
+        /// @brief Extract keys from original range.
+        /// @param original Original gradient data (full gradient or sub-section)
+        /// @param extracted Output gradient data (extracted values are appended at end)
+        /// @param distance_op Operator for calculating distance
+        template<LinearRange Range>
+        void operator()(Range original, LinearData auto& extracted, auto&& distance_op) const {
+            using namespace std;
+
+            using Iterator = LinearRange_Iterator<Range>;
+            using Value = LinearRange_Value<Range>;
+            constexpr size_t Size = Value::size;
+            ITG_TRACE_ZONE("Collapsed");
+
+            auto same_run = [&](const Value& first, const Value& key) {
+                for (size_t i = 0; i < Size; i++) {
+                    if (abs(Detail::channel(first.color, i) - Detail::channel(key.color, i)) > epsilon)
+                        return false;
+                }
+                return true;
+            };
+
+            // Run ends and their copies for inner strategy
+            vector<Iterator> ends;
+            vector<Value> collapsed;
+            for (Iterator run = begin(original); run != end(original);) {
+                Iterator run_last = run;
+                for (Iterator it = next(run); it != end(original) && same_run(*run, *it); ++it)
+                    run_last = it;
+
+                ends.push_back(run);
+                collapsed.push_back(*run);
+                if (run_last != run) {
+                    ends.push_back(run_last);
+                    collapsed.push_back(*run_last);
+                }
+                run = next(run_last);
+            }
+
+            if (collapsed.size() == size(original)) {
+                inner(original, extracted, forward<decltype(distance_op)>(distance_op));
+                return;
+            }
+
+            vector<Value> keys;
+            inner(ranges::subrange(collapsed.begin(), collapsed.end()), keys, forward<decltype(distance_op)>(distance_op));
+
+            // Map extracted keys back to original, both are in the same order
+            size_t index = 0;
+            for (const auto& key : keys) {
+                while (!(collapsed[index] == key))
+                    index++;
+                extracted.emplace_back(*ends[index++]);
+            }
+        }
+
+    };
+
+}
@@ -4,6 +4,7 @@
 #include <ranges>
 
 #include "gradient/linear.hpp"
+#include "trace/trace.hpp"
 
 namespace ItG::Gradient::Strategy {
 
@@ -0,0 +1,111 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <ranges>
+#include <vector>
+
+#include "gradient/linear.hpp"
+#include "gradient/strategy/approximate.hpp"
+
+namespace ItG::Gradient::Strategy {
+
+    /// @brief Extract keys that are close enough to original gradient, coarse-to-fine.
+    /// Keys are first extracted from a decimated gradient, moved to the farthest full resolution key in a window
+    /// around their decimated position and each section between them is then verified and split at full resolution.
+    /// Meets tolerance like Approximate, with a fraction of distance evaluations on long smooth gradients.
+    /// Keys may differ from Approximate.
+    struct Multiresolution {
+        /// @brief Maximal distance between extracted end original gradient.
+        float tolerance = 4.f / 255.f;
+        /// @brief Approximate number of keys in decimated gradient. Shorter gradients are processed by Approximate directly.
+        size_t coarse_size = 4096;
+
+        /// @brief Extract keys from original range.
+        /// @param original Original gradient data (full gradient or sub-section)
+        /// @param extracted Output gradient data (extracted values are appended at end)
+        /// @param distance_op Operator for calculating distance
+        template<LinearRange Range>
+        void operator()(Range original, LinearData auto& extracted, auto&& distance_op) const {
+            using namespace std;
+
+            using Iterator = LinearRange_Iterator<Range>;
+            using Value = LinearRange_Value<Range>;
+            ITG_TRACE_ZONE("Multiresolution");
+
+            const Approximate approximate{ .tolerance = tolerance };
+
+            const size_t factor = size(original) / max<size_t>(coarse_size, 1);
+            if (factor < 2) {
+                approximate(original, extracted, forward<decltype(distance_op)>(distance_op));
+                return;
+            }
+
+            const Iterator first = begin(original);
+            const Iterator last = prev(end(original));
+
+            // Every factor-th key and the last one
+            vector<Iterator> samples;
+            vector<Value> coarse;
+            samples.reserve(size(original) / factor + 2);
+            coarse.reserve(size(original) / factor + 2);
+            for (Iterator it = first; it != last; ranges::advance(it, factor, last)) {
+                samples.push_back(it);
+                coarse.push_back(*it);
+            }
+            samples.push_back(last);
+            coarse.push_back(*last);
+
+            vector<Value> coarse_keys;
+            approximate(ranges::subrange(coarse.begin(), coarse.end()), coarse_keys, forward<decltype(distance_op)>(distance_op));
+
+            // Map extracted keys back to full resolution, both are in the same order
+            vector<Iterator> candidates;
+            candidates.reserve(coarse_keys.size() + 1);
+            size_t sample = 0;
+            for (const auto& key : coarse_keys) {
+                while (!(coarse[sample] == key))
+                    sample++;
+                candidates.push_back(samples[sample++]);
+            }
+            candidates.push_back(last);
+
+            // Move candidates to farthest key within window, relative to previous key and next candidate
+            vector<Iterator> keys{ first };
+            keys.reserve(candidates.size() + 1);
+            for (size_t i = 0; i + 1 < candidates.size(); i++) {
+                const Iterator from = keys.back();
+                const Iterator to = candidates[i + 1];
+                const ptrdiff_t window = static_cast<ptrdiff_t>(factor) - 1;
+
+                Iterator window_begin = next(from);
+                if (distance(from, candidates[i]) > window + 1)
+                    window_begin = prev(candidates[i], window);
+                Iterator window_end = to;
+                if (distance(candidates[i], to) > window + 1)
+                    window_end = next(candidates[i], window + 1);
+
+                const float first_pos = from->position;
+                const float last_pos = to->position;
+                if (window_begin == window_end || !(last_pos > first_pos)) {
+                    keys.push_back(candidates[i]);
+                    continue;
+                }
+
+                const float scale = 1.f / (last_pos - first_pos);
+                const auto section = ranges::subrange(from, next(to));
+                auto projection = [&](const Value& key) { return distance_op(key, section, (key.position - first_pos) * scale); };
+                keys.push_back(ranges::max_element(window_begin, window_end, {}, projection));
+            }
+            keys.push_back(last);
+
+            // Verify and split sections at full resolution
+            for (size_t i = 0; i + 1 < keys.size(); i++) {
+                approximate(ranges::subrange(keys[i], next(keys[i + 1])), extracted, forward<decltype(distance_op)>(distance_op));
+                if (keys[i + 1] != last)
+                    extracted.emplace_back(*keys[i + 1]);
+            }
+        }
+
+    };
+
+}
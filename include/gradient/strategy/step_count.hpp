@@ -29,6 +29,7 @@ namespace ItG::Gradient::Strategy {
 
             using Iterator = LinearRange_Iterator<Range>;
             using IntervalEnds = std::list< Iterator >;
+            ITG_TRACE_ZONE("ColorCount");
 
             IntervalEnds current_intervals;
             current_intervals.push_front(begin(range));
@@ -90,6 +91,7 @@ namespace ItG::Gradient::Strategy {
 
             using Iterator = LinearRange_Iterator<Range>;
             using IntervalEnds = std::list< Iterator >;
+            ITG_TRACE_ZONE("StepCount");
 
             IntervalEnds current_intervals;
             current_intervals.push_front(begin(range));
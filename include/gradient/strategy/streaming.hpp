@@ -0,0 +1,204 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <concepts>
+#include <deque>
+#include <limits>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include "gradient/linear.hpp"
+#include "gradient/evaluate.hpp"
+#include "gradient/operator/max_difference.hpp"
+
+namespace ItG::Gradient::Strategy {
+
+    /// @brief One-pass extraction of keys that are close enough to original gradient, for streams of keys.
+    /// Parameters of StreamFitter and strategy that runs it over a whole range.
+    /// Keys meet tolerance like Approximate under MaxDifference, but may differ from Approximate's keys.
+    struct Streaming {
+        /// @brief Maximal distance between extracted end original gradient.
+        float tolerance = 4.f / 255.f;
+        /// @brief Maximal number of keys held between committed keys, at least 1.
+        /// A longer window gives fewer keys on long straight sections.
+        size_t window = 1024;
+
+        /// @brief Extract keys from original range. Slope intervals bound MaxDifference, other distance operators are rejected.
+        /// @param original Original gradient data (full gradient or sub-section)
+        /// @param extracted Output gradient data (extracted values are appended at end)
+        template<LinearRange Range, typename DistanceOp> requires std::same_as<std::remove_cvref_t<DistanceOp>, Operator::MaxDifference>
+        void operator()(Range original, LinearData auto& extracted, DistanceOp&&) const;
+    };
+
+    /// @brief Consumes keys one by one and emits keys as soon as they are final.
+    /// Greedy cone intersection: for each channel, slopes from the last committed key that keep all keys after it
+    /// within tolerance form an interval, narrowed by every new key in O(1).
+    /// A new key can end the current section when its slope lies in all intervals. Once an interval is empty,
+    /// the last key that could end the section is committed and the section restarts from it.
+    /// Memory is bounded by window, positions have to be non-decreasing.
+    /// @tparam TKey Key type
+    /// @tparam OnKey Callable invoked as on_key(key) for each committed key, in order of position
+    template<IsKey TKey, typename OnKey>
+    class StreamFitter {
+    public:
+        StreamFitter(Streaming parameters, OnKey on_key) : parameters(parameters), on_key(std::move(on_key)) {
+            this->parameters.window = std::max<size_t>(this->parameters.window, 1);
+            reset_cone();
+        }
+
+        /// @brief Add next key of the stream
+        void push(const TKey& key) {
+            incoming.push_back(key);
+            drain();
+        }
+
+        /// @brief End stream, last pushed key is committed. Fitter can be used for a new stream afterwards.
+        void finish() {
+            while (!pending.empty()) {
+                if (last_end == pending.size() - 1) {
+                    commit(pending.back());
+                    break;
+                }
+                restart();
+                drain();
+            }
+
+            anchor.reset();
+        }
+
+        /// @brief Keys held until they are committed or skipped
+        size_t pending_size() const {
+            return pending.size();
+        }
+
+    private:
+        static constexpr size_t Size = TKey::size;
+        static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+        void reset_cone() {
+            lower.fill(-std::numeric_limits<float>::infinity());
+            upper.fill(std::numeric_limits<float>::infinity());
+            empty = false;
+        }
+
+        /// @brief Segment from anchor to key keeps all pending keys within tolerance
+        bool ends_section(const TKey& key) const {
+            if (pending.empty())
+                return true;
+
+            const float length = key.position - anchor->position;
+            if (!(length > 0.f))
+                return false;
+
+            for (size_t c = 0; c < Size; c++) {
+                const float slope = (Detail::channel(key.color, c) - Detail::channel(anchor->color, c)) / length;
+                if (!(slope >= lower[c] && slope <= upper[c]))
+                    return false;
+            }
+            return true;
+        }
+
+        /// @brief Narrow slope intervals so that segments ending after key keep it within tolerance
+        void narrow(const TKey& key) {
+            const float length = key.position - anchor->position;
+            for (size_t c = 0; c < Size; c++) {
+                const float difference = Detail::channel(key.color, c) - Detail::channel(anchor->color, c);
+                if (length > 0.f) {
+                    lower[c] = std::max(lower[c], (difference - parameters.tolerance) / length);
+                    upper[c] = std::min(upper[c], (difference + parameters.tolerance) / length);
+                    empty = empty || lower[c] > upper[c];
+                } else {
+                    // Same position as anchor, no segment from anchor can change its distance
+                    empty = empty || std::abs(difference) > parameters.tolerance;
+                }
+            }
+        }
+
+        /// @brief Add incoming keys to current section, restarting it when needed
+        void drain() {
+            while (!incoming.empty()) {
+                const TKey& key = incoming.front();
+                if (!anchor) {
+                    commit(key);
+                    incoming.pop_front();
+                    continue;
+                }
+
+                if (ends_section(key))
+                    last_end = pending.size();
+                narrow(key);
+                pending.push_back(key);
+                incoming.pop_front();
+
+                if (empty || pending.size() >= parameters.window)
+                    restart();
+            }
+        }
+
+        /// @brief Commit last key that ends section, keys after it are added again to the new section
+        void restart() {
+            for (size_t i = pending.size(); i > last_end + 1; i--)
+                incoming.push_front(pending[i - 1]);
+            commit(pending[last_end]);
+        }
+
+        void commit(const TKey& key) {
+            on_key(key);
+            anchor.emplace(key);
+            pending.clear();
+            last_end = npos;
+            reset_cone();
+        }
+
+        Streaming parameters;
+        OnKey on_key;
+
+        /// Last committed key, start of current section
+        std::optional<TKey> anchor;
+        /// Keys after anchor
+        std::deque<TKey> pending;
+        /// Keys to add to current section
+        std::deque<TKey> incoming;
+        /// Index of last pending key that can end current section
+        size_t last_end = npos;
+
+        /// Slope intervals per channel
+        std::array<float, Size> lower;
+        std::array<float, Size> upper;
+        /// Some interval is empty, no later key can end current section
+        bool empty = false;
+    };
+
+    /// @brief Create StreamFitter for keys of type TKey
+    template<IsKey TKey, typename OnKey>
+    [[nodiscard]] StreamFitter<TKey, OnKey> stream_fitter(Streaming parameters, OnKey on_key) {
+        return StreamFitter<TKey, OnKey>(parameters, std::move(on_key));
+    }
+
+    template<LinearRange Range, typename DistanceOp> requires std::same_as<std::remove_cvref_t<DistanceOp>, Operator::MaxDifference>
+    void Streaming::operator()(Range original, LinearData auto& extracted, DistanceOp&&) const {
+        using Value = LinearRange_Value<Range>;
+        ITG_TRACE_ZONE("Streaming");
+
+        // First and last key are added by from_gradient, interior keys are held back by one
+        bool first = true;
+        std::optional<Value> held;
+        auto fitter = stream_fitter<Value>(*this, [&](const Value& key) {
+            if (first) {
+                first = false;
+                return;
+            }
+            if (held)
+                extracted.emplace_back(*held);
+            held.emplace(key);
+        });
+
+        for (const auto& key : original)
+            fitter.push(key);
+        fitter.finish();
+    }
+
+}
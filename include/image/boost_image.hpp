@@ -5,7 +5,7 @@
 #include <ranges>
 
 #include "boost_pixel.hpp"
-#include "gradient/operator/lerp.hpp"
+#include "sampler.hpp"
 #include "gradient/linear.hpp"
 
 #include "boost/gil.hpp"
@@ -24,32 +24,103 @@ namespace ItG::Image::gil {
     using RGB = ImageFloat<LayoutRGB>;
     using RGBA = ImageFloat<LayoutRGBA>;
 
+    /// @brief Image in its native pixel type, converted lazily when sampled
+    using AnyImage = boost::gil::any_image<
+        boost::gil::gray8_image_t, boost::gil::gray16_image_t, boost::gil::gray32f_image_t,
+        boost::gil::rgb8_image_t, boost::gil::rgb16_image_t, boost::gil::rgb32f_image_t,
+        boost::gil::rgba8_image_t, boost::gil::rgba16_image_t, boost::gil::rgba32f_image_t
+    >;
+
 
     template<typename View>
     inline bool is_valid(const View& view) { return view.width() > 0 && view.height() > 0; };
 
-    inline ptrdiff_t unit_to_pixel(const float& u, const ptrdiff_t& size) {
-        return std::clamp<ptrdiff_t>(static_cast<ptrdiff_t>(round(size * u)), 0, size - 1);
-    }
-
     inline boost::gil::point_t unit_to_point(const float& u, const float& v, const ptrdiff_t& width, const ptrdiff_t& height) {
         return { unit_to_pixel(u, width), unit_to_pixel(v, height) };
     }
 
+    /// @brief Pixel source for sampler over gil view. Moves xy_locator instead of random access.
+    template<typename View>
+    struct Source {
+        View view;
+
+        struct Cursor {
+            typename View::xy_locator locator;
+
+            void move_x(ptrdiff_t step) { locator.x() += step; }
+            void move_y(ptrdiff_t step) { locator.y() += step; }
+            auto color() const { return to_color(*locator); }
+        };
+
+        ptrdiff_t width() const { return view.width(); }
+        ptrdiff_t height() const { return view.height(); }
+        Cursor cursor(ptrdiff_t x, ptrdiff_t y) const { return { view.xy_at(x, y) }; }
+    };
+
+    /// @brief Pixel source over gil view of any pixel type.
+    /// Only the sampled pixels are converted to float pixels of Layout, with the same color conversion as read_and_convert_image.
+    template<typename View, typename Layout>
+    struct ConvertSource {
+        using Pixel = boost::gil::pixel<boost::gil::float32_t, Layout>;
+
+        View view;
+
+        struct Cursor {
+            typename View::xy_locator locator;
+
+            void move_x(ptrdiff_t step) { locator.x() += step; }
+            void move_y(ptrdiff_t step) { locator.y() += step; }
+            auto color() const {
+                Pixel pixel;
+                boost::gil::color_convert(*locator, pixel);
+                return to_color(pixel);
+            }
+        };
+
+        ptrdiff_t width() const { return view.width(); }
+        ptrdiff_t height() const { return view.height(); }
+        Cursor cursor(ptrdiff_t x, ptrdiff_t y) const { return { view.xy_at(x, y) }; }
+    };
+
+    /// @brief Load image keeping native pixel type
+    /// @return Empty image if format or pixel type is not supported
+    inline AnyImage load_any(const std::filesystem::path& path) {
+        ITG_TRACE_ZONE("load_any");
+
+        AnyImage image{};
+        try {
+            boost::gil::read_image(path, image, boost::gil::png_tag{});
+            return image;
+        } catch (const std::exception&) {
+
+        }
+
+        try {
+            boost::gil::read_image(path, image, boost::gil::jpeg_tag{});
+            return image;
+        } catch (const std::exception&) {
+
+        }
+
+        return {};
+    }
+
     template<typename image_t>
     image_t load(std::istream& stream) {
+        ITG_TRACE_ZONE("load");
+
         image_t image{};
         try {
             boost::gil::read_and_convert_image(stream, image, boost::gil::png_tag{});
             return image;
-        } catch (std::exception e) {
+        } catch (const std::exception&) {
 
         }
 
         try {
             boost::gil::read_and_convert_image(stream, image, boost::gil::jpeg_tag{});
             return image;
-        } catch (std::exception e) {
+        } catch (const std::exception&) {
 
         }
 
@@ -58,18 +129,20 @@ namespace ItG::Image::gil {
 
     template<typename image_t>
     image_t load(const std::filesystem::path& path) {
+        ITG_TRACE_ZONE("load");
+
         image_t image{};
         try {
             boost::gil::read_and_convert_image(path, image, boost::gil::png_tag{});
             return image;
-        } catch (std::exception e) {
+        } catch (const std::exception&) {
 
         }
 
         try {
             boost::gil::read_and_convert_image(path, image, boost::gil::jpeg_tag{});
             return image;
-        } catch (std::exception e) {
+        } catch (const std::exception&) {
 
         }
 
@@ -78,72 +151,28 @@ namespace ItG::Image::gil {
 
     template<typename View>
     inline std::vector< std::array<float, view_size<View>::value> > get_colors(View& view, const float& x1, const float& y1, const float& x2, const float& y2, const ptrdiff_t& count) {
-        constexpr size_t Size = view_size<View>::value;
-
-        if (!is_valid(view))
-            return {};
-
-        std::vector<std::array<float, Size>> colors;
-        colors.reserve(count);
-
-        const ptrdiff_t width = view.width();
-        const ptrdiff_t height = view.height();
-        const float step_x = (x2 - x1) / (count - 1);
-        const float step_y = (y2 - y1) / (count - 1);
-        float sample_x = x1;
-        float sample_y = y1;
-
-        for (ptrdiff_t i_sample = 0; i_sample < count; i_sample++, sample_x += step_x, sample_y += step_y) {
-            colors.emplace_back( to_color(
-                *view.xy_at( unit_to_point(sample_x, sample_y, width, height) )
-            ) );
-        }
-        return colors;
+        return Image::get_colors(Source<View>{ view }, x1, y1, x2, y2, count);
     }
 
     template<typename TGradient, typename View> requires Gradient::OfSize<TGradient, view_size<View>::value>
     inline TGradient get_linear(View& view, float x1, float y1, float x2, float y2) {
-        constexpr size_t Size = view_size<View>::value;
+        return Image::get_linear<TGradient>(Source<View>{ view }, x1, y1, x2, y2);
+    }
 
-        if (!is_valid(view))
-            return {};
+    /// @brief Sample image of any pixel type into reused gradient, converting to Layout only pixels on the line
+    template<typename TGradient, typename Layout> requires Gradient::OfSize<TGradient, layout_size<Layout>::value>
+    inline void get_linear_into(const AnyImage& image, float x1, float y1, float x2, float y2, TGradient& gradient) {
+        boost::gil::apply_operation(boost::gil::const_view(image), [&](const auto& view) {
+            using View = std::decay_t<decltype(view)>;
+            Image::get_linear_into(ConvertSource<View, Layout>{ view }, x1, y1, x2, y2, gradient);
+        });
+    }
 
+    /// @brief Sample image of any pixel type, converting to Layout only pixels on the line
+    template<typename TGradient, typename Layout> requires Gradient::OfSize<TGradient, layout_size<Layout>::value>
+    inline TGradient get_linear(const AnyImage& image, float x1, float y1, float x2, float y2) {
         TGradient gradient;
-
-        const ptrdiff_t width = view.width();
-        const ptrdiff_t height = view.height();
-
-        ptrdiff_t i_x1 = unit_to_pixel(x1, width);
-        ptrdiff_t i_x2 = unit_to_pixel(x2, width);
-        ptrdiff_t i_y1 = unit_to_pixel(y1, height);
-        ptrdiff_t i_y2 = unit_to_pixel(y2, height);
-
-        ptrdiff_t size_x = i_x2 - i_x1;
-        ptrdiff_t size_y = i_y2 - i_y1;
-        gradient.reserve(std::max(abs(size_x), abs(size_y)));
-
-        ptrdiff_t sample_x = i_x1;
-        ptrdiff_t sample_y = i_y1;
-        float position = 0.f;
-
-        if (std::max(abs(size_x), abs(size_y)) < 3 ) {
-            gradient.emplace_back(to_color( *view.xy_at( i_x1, i_y1 ) ), 0.f);
-            gradient.emplace_back(to_color( *view.xy_at( i_x2, i_y2 ) ), 1.f);
-        } else if (abs(size_x) >= abs(size_y)) {
-            for (int step = (size_x > 0 ? 1 : -1); sample_x != i_x2;  sample_x += step) {
-                position = fabs(float(sample_x - i_x1) / size_x);
-                sample_y = static_cast<int>(std::lerp(i_y1, i_y2, position));
-
-                gradient.emplace_back(to_color( *view.xy_at(sample_x, sample_y) ), position);
-            }
-        } else if (abs(size_x) < abs(size_y)) {
-            for (int step = (size_y > 0 ? 1 : -1); sample_y != i_y2;  sample_y += step) {
-                position = fabs(float(sample_y - i_y1) / size_y);
-                sample_x = static_cast<int>(std::lerp(i_x1, i_x2, position));
-
-                gradient.emplace_back(to_color( *view.xy_at(sample_x, sample_y) ), position);
-            }
-        }
+        get_linear_into<TGradient, Layout>(image, x1, y1, x2, y2, gradient);
         return gradient;
     }
 
@@ -23,7 +23,8 @@ namespace ItG::Image::gil {
         std::array<float, Size> result{};
         for (size_t i = 0; i < Size; i++) {
             if constexpr (std::is_integral_v<Channel>) {
-                result[i] = float(value[i]) / std::numeric_limits<Channel>::max();
+                constexpr float scale = 1.f / std::numeric_limits<Channel>::max();
+                result[i] = float(value[i]) * scale;
             } else {
                 result[i] = value[i];
             }
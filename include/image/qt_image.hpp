@@ -1,64 +1,97 @@
 #pragma once
 
 #include <QImage>
+#include <cmath>
+#include <vector>
 #include "gradient/linear.hpp"
+#include "sampler.hpp"
 
 
 namespace ItG::Image::Qt {
 
+    /// @brief Pixel format used for sampling. Byte order is R, G, B, A on any platform.
+    constexpr QImage::Format sample_format = QImage::Format_RGBA8888;
+
+    /// @brief Convert image to sampling format. Should be done once per image, sampling functions convert on each call otherwise.
+    inline QImage prepare(const QImage& image) {
+        return image.convertToFormat(sample_format);
+    }
+
     inline ItG::Color::RGBA to_color(const QRgb& value) {
         constexpr float scale = 1.f / 255.f;
         return { qRed(value) * scale, qGreen(value) * scale, qBlue(value) * scale, qAlpha(value) * scale };
     }
 
+    inline ItG::Color::RGBA to_color(const uchar* pixel) {
+        constexpr float scale = 1.f / 255.f;
+        return { pixel[0] * scale, pixel[1] * scale, pixel[2] * scale, pixel[3] * scale };
+    }
+
+
+    /// @brief Pixel source for sampler over image in sample_format. Moves raw scanline pointer.
+    struct Source {
+        const QImage& image;
+
+        struct Cursor {
+            const uchar* pixel;
+            qsizetype stride;
+
+            void move_x(ptrdiff_t step) { pixel += 4 * step; }
+            void move_y(ptrdiff_t step) { pixel += stride * step; }
+            ItG::Color::RGBA color() const { return to_color(pixel); }
+        };
+
+        ptrdiff_t width() const { return image.width(); }
+        ptrdiff_t height() const { return image.height(); }
+        Cursor cursor(ptrdiff_t x, ptrdiff_t y) const {
+            return { image.constScanLine(static_cast<int>(y)) + 4 * x, image.bytesPerLine() };
+        }
+    };
 
     inline QColor get_color(const QImage& image, float x, float y) {
-        return image.pixelColor(
-            static_cast<int>(x * (image.width() - 1)), static_cast<int>(y * (image.height() - 1))
-        );
+        if (image.isNull())
+            return {};
+        if (image.format() != sample_format)
+            return get_color(prepare(image), x, y);
+
+        const uchar* pixel = Source{ image }.cursor(unit_to_pixel(x, image.width()), unit_to_pixel(y, image.height())).pixel;
+        return QColor(pixel[0], pixel[1], pixel[2], pixel[3]);
     }
 
     inline ItG::Gradient::LinearRGBA get_linear(const QImage& image, float x1, float y1, float x2, float y2) {
         if (image.isNull())
             return {};
+        if (image.format() != sample_format)
+            return get_linear(prepare(image), x1, y1, x2, y2);
+
+        return Image::get_linear<ItG::Gradient::LinearRGBA>(Source{ image }, x1, y1, x2, y2);
+    }
+
+    /// @brief Image followed by its successive halvings in sample_format, halving stops when shorter side would be below min_size.
+    /// Built once per image, levels are used for sampling while sampled line changes quickly.
+    inline std::vector<QImage> build_pyramid(const QImage& image, int min_size = 32) {
+        std::vector<QImage> pyramid;
+        if (image.isNull())
+            return pyramid;
+
+        pyramid.push_back(prepare(image));
+        while (std::min(pyramid.back().width(), pyramid.back().height()) / 2 >= min_size) {
+            const QImage& previous = pyramid.back();
+            pyramid.push_back(prepare(previous.scaled(previous.width() / 2, previous.height() / 2, ::Qt::IgnoreAspectRatio, ::Qt::SmoothTransformation)));
+        }
+        return pyramid;
+    }
 
-        ItG::Gradient::LinearRGBA gradient;
-
-        const int width = image.width();
-        const int height = image.height();
-
-        int i_x1 = static_cast<int>(x1 * (width - 1));
-        int i_x2 = static_cast<int>(x2 * (width - 1));
-        int i_y1 = static_cast<int>(y1 * (height - 1));
-        int i_y2 = static_cast<int>(y2 * (height - 1));
-
-        int size_x = i_x2 - i_x1;
-        int size_y = i_y2 - i_y1;
-        gradient.reserve(std::max(abs(size_x), abs(size_y)));
-
-        int sample_x = i_x1;
-        int sample_y = i_y1;
-        float position = 0.f;
-
-        if (std::max(abs(size_x), abs(size_y)) < 3) {
-            gradient.emplace_back(to_color(image.pixel(i_x1, i_y1)), 0.f);
-            gradient.emplace_back(to_color(image.pixel(i_x2, i_y2)), 1.f);
-        } else if (abs(size_x) >= abs(size_y)) {
-            for (int step = (size_x > 0 ? 1 : -1); sample_x != i_x2;  sample_x += step) {
-                position = fabs(float(sample_x - i_x1) / size_x);
-                sample_y = static_cast<int>(std::lerp(i_y1, i_y2, position));
-
-                gradient.emplace_back(to_color(image.pixel(sample_x, sample_y)), position);
-            }
-        } else if (abs(size_x) < abs(size_y)) {
-            for (int step = (size_y > 0 ? 1 : -1); sample_y != i_y2;  sample_y += step) {
-                position = fabs(float(sample_y - i_y1) / size_y);
-                sample_x = static_cast<int>(std::lerp(i_x1, i_x2, position));
-                    
-                gradient.emplace_back(to_color(image.pixel(sample_x, sample_y)), position);
-            }
+    /// @brief Smallest pyramid level with at least line_pixels pixels along line, first level if none is large enough
+    inline const QImage& select_level(const std::vector<QImage>& pyramid, float x1, float y1, float x2, float y2, qreal line_pixels) {
+        size_t level = 0;
+        for (size_t i = 1; i < pyramid.size(); i++) {
+            const qreal length = std::hypot((x2 - x1) * pyramid[i].width(), (y2 - y1) * pyramid[i].height());
+            if (length < line_pixels)
+                break;
+            level = i;
         }
-        return gradient;
+        return pyramid[level];
     }
 
 }
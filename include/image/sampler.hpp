@@ -0,0 +1,144 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "gradient/linear.hpp"
+#include "trace/trace.hpp"
+
+namespace ItG::Image {
+
+    /// @brief Position in image that can be moved by whole pixels
+    template<typename T>
+    concept PixelCursor = requires (T cursor, ptrdiff_t step) {
+        { cursor.move_x(step) };
+        { cursor.move_y(step) };
+        { cursor.color() };
+    };
+
+    /// @brief Image backend that can be sampled.
+    /// Provides image size and a cursor at pixel coordinates.
+    template<typename T>
+    concept PixelSource = requires (const T& source, ptrdiff_t x, ptrdiff_t y) {
+        { source.width() } -> std::convertible_to<ptrdiff_t>;
+        { source.height() } -> std::convertible_to<ptrdiff_t>;
+        { source.cursor(x, y) } -> PixelCursor;
+    };
+
+    /// @brief Color type produced by a pixel source
+    template<PixelSource Source>
+    using PixelSource_Color = std::remove_cvref_t< decltype(std::declval<const Source&>().cursor(0, 0).color()) >;
+
+    template<PixelSource Source>
+    inline bool is_valid(const Source& source) { return source.width() > 0 && source.height() > 0; };
+
+    /// @brief Unit coordinate to pixel index, rounded to nearest pixel
+    inline ptrdiff_t unit_to_pixel(const float& u, const ptrdiff_t& size) {
+        return std::clamp<ptrdiff_t>(static_cast<ptrdiff_t>(std::round(size * u)), 0, size - 1);
+    }
+
+    /// @brief Sample colors at evenly spaced points between (x1, y1) and (x2, y2).
+    /// @param source Image
+    /// @param count Number of samples
+    template<PixelSource Source>
+    inline std::vector< PixelSource_Color<Source> > get_colors(const Source& source, const float& x1, const float& y1, const float& x2, const float& y2, const ptrdiff_t& count) {
+        if (!Image::is_valid(source) || count < 1)
+            return {};
+
+        std::vector< PixelSource_Color<Source> > colors;
+        colors.reserve(count);
+
+        const ptrdiff_t width = source.width();
+        const ptrdiff_t height = source.height();
+        const float step_x = count > 1 ? (x2 - x1) / (count - 1) : 0.f;
+        const float step_y = count > 1 ? (y2 - y1) / (count - 1) : 0.f;
+        float sample_x = x1;
+        float sample_y = y1;
+
+        for (ptrdiff_t i_sample = 0; i_sample < count; i_sample++, sample_x += step_x, sample_y += step_y) {
+            colors.emplace_back(source.cursor(unit_to_pixel(sample_x, width), unit_to_pixel(sample_y, height)).color());
+        }
+        return colors;
+    }
+
+    /// @brief Sample every pixel on line between (x1, y1) and (x2, y2), both ends included.
+    /// Uses integer Bresenham stepping, the cursor is moved by one pixel on major axis and
+    /// at most one pixel on minor axis per sample.
+    /// @param source Image
+    /// @param gradient Output with key positions in range [0, 1], previous content is replaced and capacity is reused
+    template<Gradient::LinearData TGradient, PixelSource Source>
+    inline void get_linear_into(const Source& source, float x1, float y1, float x2, float y2, TGradient& gradient) {
+        ITG_TRACE_ZONE("get_linear");
+
+        gradient.clear();
+        if (!Image::is_valid(source))
+            return;
+
+        const ptrdiff_t width = source.width();
+        const ptrdiff_t height = source.height();
+
+        const ptrdiff_t i_x1 = unit_to_pixel(x1, width);
+        const ptrdiff_t i_x2 = unit_to_pixel(x2, width);
+        const ptrdiff_t i_y1 = unit_to_pixel(y1, height);
+        const ptrdiff_t i_y2 = unit_to_pixel(y2, height);
+
+        const ptrdiff_t size_x = std::abs(i_x2 - i_x1);
+        const ptrdiff_t size_y = std::abs(i_y2 - i_y1);
+        const ptrdiff_t step_x = i_x2 >= i_x1 ? 1 : -1;
+        const ptrdiff_t step_y = i_y2 >= i_y1 ? 1 : -1;
+        const ptrdiff_t size = std::max(size_x, size_y);
+
+        auto cursor = source.cursor(i_x1, i_y1);
+
+        if (size == 0) {
+            gradient.reserve(2);
+            gradient.emplace_back(cursor.color(), 0.f);
+            gradient.emplace_back(cursor.color(), 1.f);
+            return;
+        }
+
+        gradient.reserve(size + 1);
+
+        const bool major_x = size_x >= size_y;
+        const ptrdiff_t major_size = major_x ? size_x : size_y;
+        const ptrdiff_t minor_size = major_x ? size_y : size_x;
+        const float scale = 1.f / size;
+
+        ptrdiff_t error = 2 * minor_size - major_size;
+        for (ptrdiff_t i = 0; ; i++) {
+            gradient.emplace_back(cursor.color(), i < size ? i * scale : 1.f);
+            if (i == size)
+                break;
+
+            if (error > 0) {
+                if (major_x)
+                    cursor.move_y(step_y);
+                else
+                    cursor.move_x(step_x);
+                error -= 2 * major_size;
+            }
+            error += 2 * minor_size;
+
+            if (major_x)
+                cursor.move_x(step_x);
+            else
+                cursor.move_y(step_y);
+        }
+    }
+
+    /// @brief Sample every pixel on line between (x1, y1) and (x2, y2), both ends included.
+    /// @param source Image
+    /// @return Gradient with key positions in range [0, 1]
+    template<Gradient::LinearData TGradient, PixelSource Source>
+    inline TGradient get_linear(const Source& source, float x1, float y1, float x2, float y2) {
+        TGradient gradient;
+        get_linear_into(source, x1, y1, x2, y2, gradient);
+        return gradient;
+    }
+
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <csetjmp>
+#include <cstdio>
+#include <filesystem>
+
+#include "boost_image.hpp"
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable:4611) //interaction between '_setjmp' and C++ object destruction is non-portable
+#endif
+
+namespace ItG::Image::gil {
+
+    /// @brief Image decoded at reduced resolution.
+    /// Unit coordinates cover the whole image at any resolution, so samplers need no adjustment,
+    /// a line just has fewer pixels.
+    struct ScaledImage {
+        AnyImage image;
+        /// @brief Resolution of the encoded image
+        boost::gil::point_t original_dimensions{ 0, 0 };
+
+        /// @brief Effective resolution of decoded image
+        boost::gil::point_t dimensions() const { return image.dimensions(); }
+
+        /// @brief Decoded width relative to original width, 1 if decoded at native resolution
+        double scale() const {
+            return original_dimensions.x > 0 ? double(dimensions().x) / original_dimensions.x : 1.0;
+        }
+    };
+
+    namespace Detail {
+
+        struct JpegError {
+            jpeg_error_mgr manager;
+            std::jmp_buf jump;
+        };
+
+        inline void jpeg_error_exit(j_common_ptr info) {
+            std::longjmp(reinterpret_cast<JpegError*>(info->err)->jump, 1);
+        }
+
+        enum class JpegResult {
+            Decoded,
+            /// Not a JPEG or a color space this reader doesn't handle
+            Unsupported,
+            /// Valid header, decoding failed
+            Failed
+        };
+
+        // Phases of read_jpeg_scaled set their own jump target and only have trivially destructible locals,
+        // so nothing needs destruction or keeps an indeterminate value when libjpeg jumps out.
+
+        /// @brief Read header and choose the smallest of 1/8, 1/4, 1/2 and 1 scale that is at least min_width x min_height
+        inline bool start_jpeg(jpeg_decompress_struct& info, JpegError& error, std::FILE* file, ptrdiff_t min_width, ptrdiff_t min_height, bool& supported) {
+            if (setjmp(error.jump))
+                return false;
+
+            jpeg_create_decompress(&info);
+            jpeg_stdio_src(&info, file);
+            jpeg_read_header(&info, TRUE);
+
+            const bool is_gray = info.jpeg_color_space == JCS_GRAYSCALE;
+            supported = is_gray || info.jpeg_color_space == JCS_YCbCr || info.jpeg_color_space == JCS_RGB;
+            if (!supported)
+                return true;
+            info.out_color_space = is_gray ? JCS_GRAYSCALE : JCS_RGB;
+
+            info.scale_num = 1;
+            for (unsigned denominator : { 8u, 4u, 2u, 1u }) {
+                info.scale_denom = denominator;
+                jpeg_calc_output_dimensions(&info);
+                if (ptrdiff_t(info.output_width) >= min_width && ptrdiff_t(info.output_height) >= min_height)
+                    break;
+            }
+
+            jpeg_start_decompress(&info);
+            return true;
+        }
+
+        /// @brief Decode scanlines into pixel buffer allocated before
+        inline bool read_jpeg_pixels(jpeg_decompress_struct& info, JpegError& error, unsigned char* pixels, ptrdiff_t row_size) {
+            if (setjmp(error.jump))
+                return false;
+
+            while (info.output_scanline < info.output_height) {
+                JSAMPROW row = pixels + static_cast<ptrdiff_t>(info.output_scanline) * row_size;
+                jpeg_read_scanlines(&info, &row, 1);
+            }
+            jpeg_finish_decompress(&info);
+            return true;
+        }
+
+        /// @brief Decode JPEG with DCT scaling, smallest of 1/8, 1/4, 1/2 and 1 that is at least min_width x min_height.
+        inline JpegResult read_jpeg_scaled(std::FILE* file, ptrdiff_t min_width, ptrdiff_t min_height, ScaledImage& result) {
+            jpeg_decompress_struct info{};
+            JpegError error{};
+            info.err = jpeg_std_error(&error.manager);
+            error.manager.error_exit = jpeg_error_exit;
+            error.manager.output_message = [](j_common_ptr) {};
+
+            bool supported = false;
+            if (!start_jpeg(info, error, file, min_width, min_height, supported) || !supported) {
+                jpeg_destroy_decompress(&info);
+                return JpegResult::Unsupported;
+            }
+
+            result.original_dimensions = { ptrdiff_t(info.image_width), ptrdiff_t(info.image_height) };
+
+            // Pixels are allocated outside of the jumping phases and only written through a pointer
+            bool decoded = false;
+            if (info.out_color_space == JCS_GRAYSCALE) {
+                boost::gil::gray8_image_t gray(info.output_width, info.output_height);
+                auto view = boost::gil::view(gray);
+                decoded = read_jpeg_pixels(info, error, reinterpret_cast<unsigned char*>(&view(0, 0)), view.pixels().row_size());
+                if (decoded)
+                    result.image.emplace<boost::gil::gray8_image_t>(std::move(gray));
+            } else {
+                boost::gil::rgb8_image_t rgb(info.output_width, info.output_height);
+                auto view = boost::gil::view(rgb);
+                decoded = read_jpeg_pixels(info, error, reinterpret_cast<unsigned char*>(&view(0, 0)), view.pixels().row_size());
+                if (decoded)
+                    result.image.emplace<boost::gil::rgb8_image_t>(std::move(rgb));
+            }
+
+            jpeg_destroy_decompress(&info);
+            return decoded ? JpegResult::Decoded : JpegResult::Failed;
+        }
+
+    }
+
+    /// @brief Load image at reduced resolution of at least min_width x min_height pixels.
+    /// JPEG is scaled in DCT domain by 1/2, 1/4 or 1/8, which skips most of decoding work and memory.
+    /// Other formats are decoded at native resolution.
+    /// @param min_width Smallest acceptable width, 0 for any
+    /// @param min_height Smallest acceptable height, 0 for any
+    /// @return Empty image if format or pixel type is not supported or decoding fails
+    inline ScaledImage load_scaled(const std::filesystem::path& path, ptrdiff_t min_width, ptrdiff_t min_height) {
+        ITG_TRACE_ZONE("load_scaled");
+
+#ifdef _WIN32
+        std::FILE* file = _wfopen(path.c_str(), L"rb");
+#else
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+#endif
+        if (file) {
+            ScaledImage scaled{};
+            const auto decoded = Detail::read_jpeg_scaled(file, min_width, min_height, scaled);
+            std::fclose(file);
+            // A broken JPEG would fail again in load_any
+            if (decoded == Detail::JpegResult::Decoded)
+                return scaled;
+            if (decoded == Detail::JpegResult::Failed)
+                return {};
+        }
+
+        ScaledImage result{ load_any(path) };
+        result.original_dimensions = result.image.dimensions();
+        return result;
+    }
+
+}
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <filesystem>
+#include <cmath>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+#include "boost_image.hpp"
+
+namespace ItG::Image::gil {
+
+    /// @brief Image file decoded on demand in square tiles.
+    /// Only tiles touched by a cursor are decoded, decoded tiles are kept in LRU cache
+    /// limited by memory budget. Can be used as PixelSource for sampler.
+    /// Interlaced PNG files are rejected, the decoder reads them in full regardless of the decoded region.
+    /// Progressive JPEG decoder keeps coefficients of the whole image (about 2 bytes per sample) outside of the budget.
+    /// Not thread safe, cursors of one source must be used from one thread.
+    template<typename Layout>
+    struct TiledSource {
+        using Tile = ImageFloat<Layout>;
+        using TileView = typename Tile::view_t;
+
+        struct Options {
+            /// @brief Tile width and height in pixels
+            ptrdiff_t tile_size = 256;
+            /// @brief Maximal memory used by decoded tiles in bytes. At least one tile is always kept.
+            /// Tiles evicted while a cursor is on them are released when the cursor leaves them.
+            size_t memory_budget = size_t(256) << 20;
+        };
+
+        /// @brief Shared decoding state, cursors keep pointer to it
+        struct Cache {
+            enum class Format { Unknown, PNG, JPEG };
+
+            std::filesystem::path path;
+            Options options;
+            Format format = Format::Unknown;
+            ptrdiff_t width = 0;
+            ptrdiff_t height = 0;
+
+            /// @brief Decoded tiles, most recently used first
+            std::list< std::pair< uint64_t, std::shared_ptr<Tile> > > tiles;
+            std::unordered_map< uint64_t, typename decltype(tiles)::iterator > index;
+            size_t memory_usage = 0;
+            size_t decoded = 0;
+            /// @brief A block failed to decode, its tiles are blank and sampled lines are discarded
+            bool failed = false;
+
+            static constexpr size_t pixel_bytes = sizeof(typename Tile::value_type);
+
+            size_t tile_bytes(const Tile& tile) const {
+                return tile.width() * tile.height() * pixel_bytes;
+            }
+
+            /// @brief Tiles per side of a decoded block. Neighbouring tiles are decoded together
+            /// to reduce number of decoder passes, block and its tiles use at most half of the budget.
+            ptrdiff_t block_tiles() const {
+                const size_t tile = options.tile_size * options.tile_size * pixel_bytes;
+                const size_t count = std::max<size_t>(options.memory_budget / (4 * tile), 1);
+                return std::max<ptrdiff_t>(static_cast<ptrdiff_t>(std::sqrt(double(count))), 1);
+            }
+
+            void evict(size_t limit) {
+                while (!tiles.empty() && memory_usage > limit) {
+                    memory_usage -= tile_bytes(*tiles.back().second);
+                    index.erase(tiles.back().first);
+                    tiles.pop_back();
+                }
+            }
+
+            Tile read(const boost::gil::point_t& top_left, const boost::gil::point_t& dim) {
+                Tile region;
+                try {
+                    if (format == Format::PNG) {
+                        boost::gil::read_and_convert_image(path, region, boost::gil::image_read_settings<boost::gil::png_tag>(top_left, dim));
+                    } else if (format == Format::JPEG) {
+                        boost::gil::read_and_convert_image(path, region, boost::gil::image_read_settings<boost::gil::jpeg_tag>(top_left, dim));
+                    }
+                } catch (const std::exception&) {
+                    failed = true;
+                }
+
+                // Keep region size consistent with image size, cursors stay valid until the line is finished
+                if (region.width() != dim.x || region.height() != dim.y) {
+                    failed = true;
+                    region.recreate(dim);
+                    boost::gil::fill_pixels(boost::gil::view(region), typename Tile::value_type{});
+                }
+                return region;
+            }
+
+            /// @brief Decode block of tiles containing tile (tile_x, tile_y) and add missing tiles to cache
+            void decode(ptrdiff_t tile_x, ptrdiff_t tile_y) {
+                ITG_TRACE_ZONE("decode tiles");
+
+                const ptrdiff_t size = options.tile_size;
+                const ptrdiff_t block = block_tiles();
+
+                const boost::gil::point_t first{ tile_x / block * block, tile_y / block * block };
+                const boost::gil::point_t top_left{ first.x * size, first.y * size };
+                const boost::gil::point_t dim{ std::min(block * size, width - top_left.x), std::min(block * size, height - top_left.y) };
+
+                // Region and tiles copied from it must fit into budget
+                const size_t region_bytes = dim.x * dim.y * pixel_bytes;
+                evict(options.memory_budget > 2 * region_bytes ? options.memory_budget - 2 * region_bytes : 0);
+
+                Tile region = read(top_left, dim);
+                decoded++;
+
+                for (ptrdiff_t y = 0; y < dim.y; y += size) {
+                    for (ptrdiff_t x = 0; x < dim.x; x += size) {
+                        const uint64_t key = (uint64_t(first.y + y / size) << 32) | uint64_t(first.x + x / size);
+                        if (index.contains(key))
+                            continue;
+
+                        const boost::gil::point_t tile_dim{ std::min(size, dim.x - x), std::min(size, dim.y - y) };
+                        auto tile = std::make_shared<Tile>(tile_dim);
+                        boost::gil::copy_pixels(boost::gil::subimage_view(boost::gil::view(region), { x, y }, tile_dim), boost::gil::view(*tile));
+
+                        memory_usage += tile_bytes(*tile);
+                        tiles.emplace_front(key, std::move(tile));
+                        index.emplace(key, tiles.begin());
+                    }
+                }
+            }
+
+            /// @brief Get decoded tile, decode it and evict least recently used tiles if needed
+            std::shared_ptr<Tile> get(ptrdiff_t tile_x, ptrdiff_t tile_y) {
+                const uint64_t key = (uint64_t(tile_y) << 32) | uint64_t(tile_x);
+
+                auto found = index.find(key);
+                if (found == index.end()) {
+                    decode(tile_x, tile_y);
+                    found = index.find(key);
+                }
+
+                tiles.splice(tiles.begin(), tiles, found->second);
+                return found->second->second;
+            }
+        };
+
+        struct Cursor {
+            Cache* cache = nullptr;
+            ptrdiff_t x = 0;
+            ptrdiff_t y = 0;
+
+            /// @brief Current tile, kept alive even if evicted from cache
+            std::shared_ptr<Tile> tile;
+            ptrdiff_t tile_x = -1;
+            ptrdiff_t tile_y = -1;
+            typename TileView::xy_locator locator;
+
+            void move_x(ptrdiff_t step) {
+                x += step;
+                if (!update())
+                    locator.x() += step;
+            }
+
+            void move_y(ptrdiff_t step) {
+                y += step;
+                if (!update())
+                    locator.y() += step;
+            }
+
+            auto color() const { return to_color(*locator); }
+
+            /// @brief Switch tile if position left current one
+            /// @return true if locator was recreated
+            bool update() {
+                const ptrdiff_t size = cache->options.tile_size;
+                const ptrdiff_t new_x = x / size;
+                const ptrdiff_t new_y = y / size;
+                if (new_x == tile_x && new_y == tile_y)
+                    return false;
+
+                tile_x = new_x;
+                tile_y = new_y;
+                tile = cache->get(tile_x, tile_y);
+                locator = boost::gil::view(*tile).xy_at(x - tile_x * size, y - tile_y * size);
+                return true;
+            }
+        };
+
+        std::shared_ptr<Cache> cache;
+
+        TiledSource(const std::filesystem::path& path, const Options& options = {}) : cache(std::make_shared<Cache>()) {
+            cache->path = path;
+            cache->options = options;
+            cache->options.tile_size = std::max<ptrdiff_t>(options.tile_size, 1);
+
+            try {
+                auto info = boost::gil::read_image_info(path, boost::gil::png_tag{});
+                if (info._info._interlace_method != PNG_INTERLACE_NONE)
+                    return;
+                cache->format = Cache::Format::PNG;
+                cache->width = info._info._width;
+                cache->height = info._info._height;
+                return;
+            } catch (const std::exception&) {
+
+            }
+
+            try {
+                auto info = boost::gil::read_image_info(path, boost::gil::jpeg_tag{});
+                cache->format = Cache::Format::JPEG;
+                cache->width = info._info._width;
+                cache->height = info._info._height;
+                return;
+            } catch (const std::exception&) {
+
+            }
+        }
+
+        /// @brief Header was read and no block failed to decode so far
+        bool valid() const { return cache->format != Cache::Format::Unknown && !cache->failed; }
+
+        ptrdiff_t width() const { return cache->width; }
+        ptrdiff_t height() const { return cache->height; }
+
+        Cursor cursor(ptrdiff_t x, ptrdiff_t y) const {
+            Cursor cursor;
+            cursor.cache = cache.get();
+            cursor.x = x;
+            cursor.y = y;
+            cursor.update();
+            return cursor;
+        }
+
+        /// @brief Memory used by decoded tiles in cache
+        size_t memory_usage() const { return cache->memory_usage; }
+
+        /// @brief Number of decoder passes since creation
+        size_t decoded_blocks() const { return cache->decoded; }
+    };
+
+    template<typename TGradient, typename Layout> requires Gradient::OfSize<TGradient, layout_size<Layout>::value>
+    inline TGradient get_linear(const TiledSource<Layout>& source, float x1, float y1, float x2, float y2) {
+        TGradient gradient = Image::get_linear<TGradient>(source, x1, y1, x2, y2);
+        // Line crossing a corrupt block would fit blank tiles
+        if (!source.valid())
+            gradient.clear();
+        return gradient;
+    }
+
+}
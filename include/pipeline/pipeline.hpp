@@ -0,0 +1,172 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "pipeline/queue.hpp"
+#include "trace/trace.hpp"
+
+namespace ItG::Pipeline {
+
+    /// @brief Counters of a pipeline stage
+    struct StageMetrics {
+        std::string name;
+        size_t threads = 0;
+        /// @brief Number of processed values
+        std::atomic<size_t> processed{ 0 };
+        /// @brief Number of values whose stage function threw, included in processed
+        std::atomic<size_t> failed{ 0 };
+        /// @brief Total time spent in stage function by all threads
+        std::atomic<int64_t> busy_ns{ 0 };
+        /// @brief Total time spent waiting for input or for space in output by all threads
+        std::atomic<int64_t> wait_ns{ 0 };
+        /// @brief Highest observed depth of input queue
+        std::function<size_t()> input_depth;
+        /// @brief Capacity of input queue
+        size_t input_capacity = 0;
+    };
+
+    /// @brief Runs pipeline stages in separate thread pools connected by bounded queues.
+    /// Each stage pops values from input queue, processes them and pushes results to output queue.
+    /// Full queues block producers, so memory use is bounded by queue capacities.
+    /// Output queue of a stage is closed when all its threads finish.
+    /// Exception thrown by a stage function fails only its value, the stage keeps running.
+    class Executor {
+    public:
+        Executor() = default;
+        Executor(const Executor&) = delete;
+        Executor& operator=(const Executor&) = delete;
+
+        ~Executor() { wait(); }
+
+        /// @brief Add stage transforming values from input to output queue
+        /// @param name Stage name for metrics
+        /// @param threads Number of threads processing values
+        /// @param function Callable Out(In&&), taking the value by reference keeps it intact for failure if function throws
+        /// @param failure Callable Out(In&&) producing output for a value function threw on, the value is dropped if null
+        template<typename In, typename Out, typename Function, typename Failure = std::nullptr_t>
+        void add_stage(std::string name, size_t threads, BoundedQueue<In>& input, BoundedQueue<Out>& output, Function function, Failure failure = nullptr) {
+            StageMetrics& metrics = add_metrics(std::move(name), threads, input);
+            auto remaining = std::make_shared< std::atomic<size_t> >(metrics.threads);
+
+            for (size_t i = 0; i < metrics.threads; i++) {
+                workers.emplace_back([&input, &output, &metrics, remaining, function, failure]() mutable {
+#ifdef ITG_TRACE
+                    const char* zone_name = Trace::Registry::instance().intern(metrics.name);
+                    Trace::set_thread_name(metrics.name);
+#endif
+                    In value{};
+                    for (;;) {
+                        auto wait_start = Clock::now();
+                        if (!input.pop(value))
+                            break;
+                        auto busy_start = Clock::now();
+
+                        std::optional<Out> result;
+                        try {
+                            ITG_TRACE_ZONE(zone_name);
+                            result.emplace(function(std::move(value)));
+                        } catch (...) {
+                            metrics.failed.fetch_add(1, std::memory_order_relaxed);
+                            if constexpr (!std::is_null_pointer_v<Failure>)
+                                result.emplace(failure(std::move(value)));
+                        }
+
+                        auto busy_end = Clock::now();
+                        if (result)
+                            output.push(std::move(*result));
+
+                        metrics.processed.fetch_add(1, std::memory_order_relaxed);
+                        metrics.busy_ns.fetch_add(nanoseconds(busy_end - busy_start), std::memory_order_relaxed);
+                        metrics.wait_ns.fetch_add(nanoseconds(busy_start - wait_start) + nanoseconds(Clock::now() - busy_end), std::memory_order_relaxed);
+                    }
+
+                    if (remaining->fetch_sub(1, std::memory_order_acq_rel) == 1)
+                        output.close();
+                });
+            }
+        }
+
+        /// @brief Add final stage consuming values from input queue
+        /// @param name Stage name for metrics
+        /// @param threads Number of threads processing values
+        /// @param function Callable void(In&&)
+        /// @param failure Callable void(In&&) called with a value function threw on, ignored if null
+        template<typename In, typename Function, typename Failure = std::nullptr_t>
+        void add_sink(std::string name, size_t threads, BoundedQueue<In>& input, Function function, Failure failure = nullptr) {
+            StageMetrics& metrics = add_metrics(std::move(name), threads, input);
+
+            for (size_t i = 0; i < metrics.threads; i++) {
+                workers.emplace_back([&input, &metrics, function, failure]() mutable {
+#ifdef ITG_TRACE
+                    const char* zone_name = Trace::Registry::instance().intern(metrics.name);
+                    Trace::set_thread_name(metrics.name);
+#endif
+                    In value{};
+                    for (;;) {
+                        auto wait_start = Clock::now();
+                        if (!input.pop(value))
+                            break;
+                        auto busy_start = Clock::now();
+
+                        try {
+                            ITG_TRACE_ZONE(zone_name);
+                            function(std::move(value));
+                        } catch (...) {
+                            metrics.failed.fetch_add(1, std::memory_order_relaxed);
+                            if constexpr (!std::is_null_pointer_v<Failure>)
+                                failure(std::move(value));
+                        }
+
+                        metrics.processed.fetch_add(1, std::memory_order_relaxed);
+                        metrics.busy_ns.fetch_add(nanoseconds(Clock::now() - busy_start), std::memory_order_relaxed);
+                        metrics.wait_ns.fetch_add(nanoseconds(busy_start - wait_start), std::memory_order_relaxed);
+                    }
+                });
+            }
+        }
+
+        /// @brief Wait until all stages finish. Input queue of the first stage has to be closed.
+        void wait() {
+            for (auto& worker : workers) {
+                if (worker.joinable())
+                    worker.join();
+            }
+            workers.clear();
+        }
+
+        /// @brief Stage counters in order of addition
+        [[nodiscard]] const std::deque<StageMetrics>& metrics() const { return stages; }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        static int64_t nanoseconds(Clock::duration duration) {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+        }
+
+        template<typename In>
+        StageMetrics& add_metrics(std::string name, size_t threads, BoundedQueue<In>& input) {
+            StageMetrics& metrics = stages.emplace_back();
+            metrics.name = std::move(name);
+            metrics.threads = std::max<size_t>(threads, 1);
+            metrics.input_depth = [&input]() { return input.max_depth(); };
+            metrics.input_capacity = input.max_size();
+            return metrics;
+        }
+
+        // Deque keeps metrics addresses stable for worker threads
+        std::deque<StageMetrics> stages;
+        std::vector<std::thread> workers;
+    };
+
+}
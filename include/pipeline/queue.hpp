@@ -0,0 +1,168 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+#include "trace/trace.hpp"
+
+namespace ItG::Pipeline {
+
+    /// @brief Bounded multi-producer multi-consumer queue.
+    /// Lock-free ring buffer with per-cell sequence numbers, blocking operations wait on atomics.
+    /// @tparam T Value type, must be default constructible and move assignable
+    template<typename T>
+    class BoundedQueue {
+    public:
+        /// @brief Create queue
+        /// @param requested Maximal number of queued values, rounded up to power of two
+        explicit BoundedQueue(size_t requested) :
+            capacity(std::bit_ceil(std::max<size_t>(requested, 2))),
+            mask(capacity - 1),
+            cells(std::make_unique<Cell[]>(capacity))
+        {
+            for (size_t i = 0; i < this->capacity; i++)
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        BoundedQueue(const BoundedQueue&) = delete;
+        BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+        /// @brief Add value if queue is not full
+        bool try_push(T& value) {
+            size_t position = enqueue_position.load(std::memory_order_relaxed);
+            for (;;) {
+                Cell& cell = cells[position & mask];
+                const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+                if (difference == 0) {
+                    if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        cell.value = std::move(value);
+                        cell.sequence.store(position + 1, std::memory_order_release);
+                        update_depth(position + 1);
+                        notify(pushed);
+                        return true;
+                    }
+                } else if (difference < 0) {
+                    return false;
+                } else {
+                    position = enqueue_position.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /// @brief Take value if queue is not empty
+        bool try_pop(T& value) {
+            size_t position = dequeue_position.load(std::memory_order_relaxed);
+            for (;;) {
+                Cell& cell = cells[position & mask];
+                const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+                if (difference == 0) {
+                    if (dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        value = std::move(cell.value);
+                        cell.sequence.store(position + mask + 1, std::memory_order_release);
+                        notify(popped);
+                        return true;
+                    }
+                } else if (difference < 0) {
+                    return false;
+                } else {
+                    position = dequeue_position.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /// @brief Add value, wait while queue is full
+        /// @return false if queue was closed
+        bool push(T&& value) {
+            for (;;) {
+                if (closed.load(std::memory_order_acquire))
+                    return false;
+
+                const size_t version = popped.load(std::memory_order_acquire);
+                if (try_push(value))
+                    return true;
+                wait(popped, version);
+            }
+        }
+
+        /// @brief Take value, wait while queue is empty
+        /// @return false if queue is closed and empty
+        bool pop(T& value) {
+            for (;;) {
+                const size_t version = pushed.load(std::memory_order_acquire);
+                if (try_pop(value))
+                    return true;
+                if (closed.load(std::memory_order_acquire)) {
+                    // Values pushed before close are still delivered
+                    return try_pop(value);
+                }
+                wait(pushed, version);
+            }
+        }
+
+        /// @brief Reject further pushes and wake up waiting consumers once queue is drained
+        void close() {
+            closed.store(true, std::memory_order_release);
+            pushed.fetch_add(1, std::memory_order_acq_rel);
+            pushed.notify_all();
+            popped.fetch_add(1, std::memory_order_acq_rel);
+            popped.notify_all();
+        }
+
+        [[nodiscard]] bool is_closed() const { return closed.load(std::memory_order_acquire); }
+
+        /// @brief Approximate number of queued values
+        [[nodiscard]] size_t size() const {
+            const size_t enqueued = enqueue_position.load(std::memory_order_relaxed);
+            const size_t dequeued = dequeue_position.load(std::memory_order_relaxed);
+            return enqueued > dequeued ? enqueued - dequeued : 0;
+        }
+
+        /// @brief Highest observed number of queued values
+        [[nodiscard]] size_t max_depth() const { return depth.load(std::memory_order_relaxed); }
+
+        [[nodiscard]] size_t max_size() const { return capacity; }
+
+    private:
+        struct Cell {
+            std::atomic<size_t> sequence{ 0 };
+            T value{};
+        };
+
+        static constexpr size_t cache_line = 64;
+
+        void update_depth(size_t enqueued) {
+            const size_t dequeued = dequeue_position.load(std::memory_order_relaxed);
+            const size_t current = enqueued > dequeued ? enqueued - dequeued : 0;
+            size_t observed = depth.load(std::memory_order_relaxed);
+            while (current > observed && !depth.compare_exchange_weak(observed, current, std::memory_order_relaxed)) {}
+        }
+
+        static void notify(std::atomic<size_t>& version) {
+            version.fetch_add(1, std::memory_order_acq_rel);
+            version.notify_one();
+        }
+
+        static void wait(std::atomic<size_t>& version, size_t old) {
+            ITG_TRACE_ZONE("queue wait");
+            version.wait(old, std::memory_order_acquire);
+        }
+
+        const size_t capacity;
+        const size_t mask;
+        std::unique_ptr<Cell[]> cells;
+
+        alignas(cache_line) std::atomic<size_t> enqueue_position{ 0 };
+        alignas(cache_line) std::atomic<size_t> dequeue_position{ 0 };
+        alignas(cache_line) std::atomic<size_t> pushed{ 0 };
+        alignas(cache_line) std::atomic<size_t> popped{ 0 };
+        alignas(cache_line) std::atomic<size_t> depth{ 0 };
+        std::atomic<bool> closed{ false };
+    };
+
+}
@@ -0,0 +1,177 @@
+﻿#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// Scoped trace zones exported as Chrome trace (chrome://tracing, Perfetto).
+/// Zones are compiled out unless ITG_TRACE is defined (IMAGE_TO_GRADIENT_TRACE CMake option).
+namespace ItG::Trace {
+
+#ifdef ITG_TRACE
+    constexpr bool enabled = true;
+#else
+    constexpr bool enabled = false;
+#endif
+
+    /// @brief Completed zone
+    struct Event {
+        /// @brief Zone name, has to outlive the trace
+        const char* name = nullptr;
+        int64_t begin_ns = 0;
+        int64_t end_ns = 0;
+    };
+
+    /// @brief Events of one thread. Ring buffer, oldest events are overwritten when full.
+    struct ThreadBuffer {
+        static constexpr size_t capacity = 1 << 16;
+
+        uint32_t thread_id = 0;
+        std::string thread_name;
+        std::array<Event, capacity> events{};
+        /// @brief Number of recorded events, including overwritten ones
+        std::atomic<size_t> count{ 0 };
+
+        void record(const Event& event) {
+            const size_t current = count.load(std::memory_order_relaxed);
+            events[current % capacity] = event;
+            count.store(current + 1, std::memory_order_release);
+        }
+    };
+
+    /// @brief Buffers of all threads that recorded an event
+    class Registry {
+    public:
+        static Registry& instance() {
+            static Registry registry;
+            return registry;
+        }
+
+        /// @brief Nanoseconds since registry creation
+        int64_t now() const {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - epoch).count();
+        }
+
+        /// @brief Buffer of calling thread, registered on first use
+        ThreadBuffer& local() {
+            thread_local std::shared_ptr<ThreadBuffer> buffer = add();
+            return *buffer;
+        }
+
+        /// @brief Copy of name that lives as long as the registry, for zones with runtime names
+        const char* intern(std::string name) {
+            std::lock_guard lock(mutex);
+            return names.emplace_back(std::move(name)).c_str();
+        }
+
+        /// @brief Write Chrome trace JSON. Threads should not record while writing.
+        void write(std::ostream& output) {
+            std::lock_guard lock(mutex);
+
+            output << std::fixed << std::setprecision(3);
+            output << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+            bool first = true;
+            auto separator = [&]() -> std::ostream& {
+                if (!first)
+                    output << ",\n";
+                first = false;
+                return output;
+            };
+
+            for (const auto& buffer : buffers) {
+                if (!buffer->thread_name.empty()) {
+                    separator() << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->thread_id
+                        << ",\"args\":{\"name\":\"" << buffer->thread_name << "\"}}";
+                }
+
+                const size_t count = buffer->count.load(std::memory_order_acquire);
+                const size_t begin = count > ThreadBuffer::capacity ? count - ThreadBuffer::capacity : 0;
+                for (size_t i = begin; i < count; i++) {
+                    const Event& event = buffer->events[i % ThreadBuffer::capacity];
+                    // Timestamps are in microseconds
+                    separator() << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread_id
+                        << ",\"ts\":" << event.begin_ns / 1000.0
+                        << ",\"dur\":" << (event.end_ns - event.begin_ns) / 1000.0 << "}";
+                }
+            }
+
+            output << "]}\n";
+        }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        Registry() = default;
+
+        std::shared_ptr<ThreadBuffer> add() {
+            auto buffer = std::make_shared<ThreadBuffer>();
+            std::lock_guard lock(mutex);
+            buffer->thread_id = static_cast<uint32_t>(buffers.size() + 1);
+            buffers.push_back(buffer);
+            return buffer;
+        }
+
+        const Clock::time_point epoch = Clock::now();
+        std::mutex mutex;
+        // Shared with thread_local pointers, buffers outlive their threads
+        std::vector< std::shared_ptr<ThreadBuffer> > buffers;
+        std::deque<std::string> names;
+    };
+
+    /// @brief Records event from construction to destruction into thread's buffer
+    class Zone {
+    public:
+        explicit Zone(const char* name) : name(name), begin_ns(Registry::instance().now()) {}
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+
+        ~Zone() {
+            Registry& registry = Registry::instance();
+            registry.local().record({ name, begin_ns, registry.now() });
+        }
+
+    private:
+        const char* name;
+        int64_t begin_ns;
+    };
+
+    /// @brief Name calling thread in trace
+    inline void set_thread_name(std::string name) {
+        Registry::instance().local().thread_name = std::move(name);
+    }
+
+    /// @brief Write recorded events to Chrome trace JSON file
+    /// @return false if tracing is compiled out or file can't be written
+    inline bool save(const std::filesystem::path& path) {
+        if constexpr (!enabled)
+            return false;
+
+        std::ofstream output(path);
+        if (!output)
+            return false;
+        Registry::instance().write(output);
+        return static_cast<bool>(output);
+    }
+
+}
+
+#define ITG_TRACE_CONCAT_IMPL(a, b) a##b
+#define ITG_TRACE_CONCAT(a, b) ITG_TRACE_CONCAT_IMPL(a, b)
+
+#ifdef ITG_TRACE
+/// @brief Trace current scope, name has to outlive the trace (string literal or Registry::intern)
+#define ITG_TRACE_ZONE(name) const ::ItG::Trace::Zone ITG_TRACE_CONCAT(itg_trace_zone_, __LINE__){ name }
+/// @brief Name current thread in trace
+#define ITG_TRACE_THREAD(name) ::ItG::Trace::set_thread_name(name)
+#else
+#define ITG_TRACE_ZONE(name) ((void)0)
+#define ITG_TRACE_THREAD(name) ((void)0)
+#endif
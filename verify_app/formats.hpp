@@ -0,0 +1,162 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "generators.hpp"
+#include "gradient/format/css.hpp"
+#include "gradient/format/svg.hpp"
+#include "gradient/format/parse.hpp"
+
+namespace ItG::Verify {
+
+    /// @brief Accumulated results of a format check
+    struct FormatStatistics {
+        size_t runs = 0;
+        size_t failures = 0;
+    };
+
+    /// @brief Keys are equal up to rounding of written numbers with given precision
+    template<size_t N>
+    bool close_keys(const LinearN<N>& expected, const LinearN<N>& actual, float position_step, float color_step, float alpha_step) {
+        if (expected.size() != actual.size())
+            return false;
+        for (size_t i = 0; i < expected.size(); i++) {
+            if (!(std::abs(expected[i].position - actual[i].position) <= position_step))
+                return false;
+            for (size_t c = 0; c < N; c++) {
+                const float step = c == 3 ? alpha_step : color_step;
+                if (!(std::abs(expected[i].color[c] - actual[i].color[c]) <= step))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    template<size_t N>
+    void clamp_colors(LinearN<N>& gradient) {
+        for (auto& key : gradient)
+            for (auto& value : key.color)
+                value = std::clamp(value, 0.f, 1.f);
+    }
+
+    /// @brief Write input as CSS or SVG, read it back with GradientReader and compare
+    template<size_t N> requires (N == 3 || N == 4)
+    bool round_trip(const LinearN<N>& input, Gradient::Format::Syntax syntax) {
+        using namespace Gradient::Format;
+
+        const Options options{ .precision = 4 };
+        // Half of last written digit, in units of the value, plus float rounding
+        const float digit = 0.5e-4f;
+        const float slack = 1e-5f;
+
+        std::vector<char> buffer(syntax == Syntax::CSS ? css_capacity(input, options) : svg_capacity(input, "gradient", options));
+        const auto written = syntax == Syntax::CSS ? to_css(buffer, input, options) : to_svg(buffer, input, "gradient", options);
+        if (written.ec != std::errc{})
+            return false;
+
+        // Text around the gradient is skipped
+        std::string text = "a { background: ";
+        text.append(buffer.data(), written.ptr);
+        text += "; }";
+
+        GradientReader reader(text, syntax);
+        LinearN<N> output;
+        if (!reader.next(output) || reader.errors() != 0)
+            return false;
+
+        // SVG opacity is written as fraction, CSS alpha as percentage
+        const float alpha_step = syntax == Syntax::CSS ? digit / 100.f : digit;
+        return close_keys<N>(input, output, digit / 100.f + slack, digit / 255.f + slack, alpha_step + slack);
+    }
+
+    /// @brief Text with expected parse result
+    struct ParseCase {
+        std::string_view text;
+        Gradient::Format::Syntax syntax;
+        /// @brief Expected keys, empty if text is invalid
+        LinearN<4> keys;
+    };
+
+    inline std::vector<ParseCase> parse_cases() {
+        using Gradient::Format::Syntax;
+        const float third = 1.f / 3.f;
+
+        return {
+            // First argument is a stop, not a direction
+            { "linear-gradient(red 0%, #fff 50%, #000 100%)", Syntax::CSS, { { {{ 1, 0, 0, 1 }}, 0.f }, { {{ 1, 1, 1, 1 }}, 0.5f }, { {{ 0, 0, 0, 1 }}, 1.f } } },
+            { "linear-gradient(RebeccaPurple, tomato)", Syntax::CSS, { { {{ 0.4f, 0.2f, 0.6f, 1 }}, 0.f }, { {{ 1, 99 / 255.f, 71 / 255.f, 1 }}, 1.f } } },
+            { "linear-gradient(to top right, navy, transparent)", Syntax::CSS, { { {{ 0, 0, 128 / 255.f, 1 }}, 0.f }, { {{ 0, 0, 0, 0 }}, 1.f } } },
+            { "linear-gradient(0.25turn, lime, 50%, rgb(0 0 255 / 50%))", Syntax::CSS, { { {{ 0, 1, 0, 1 }}, 0.f }, { {{ 0, 0, 1, 0.5f }}, 1.f } } },
+            { "linear-gradient(-45deg, white, gray, black)", Syntax::CSS,
+                { { {{ 1, 1, 1, 1 }}, 0.f }, { {{ 128 / 255.f, 128 / 255.f, 128 / 255.f, 1 }}, 0.5f }, { {{ 0, 0, 0, 1 }}, 1.f } } },
+            { "linear-gradient(1rad, #000 0% 33.333333%, #fff)", Syntax::CSS,
+                { { {{ 0, 0, 0, 1 }}, 0.f }, { {{ 0, 0, 0, 1 }}, third }, { {{ 1, 1, 1, 1 }}, 1.f } } },
+            { "linear-gradient(notacolor, red)", Syntax::CSS, {} },
+            { "linear-gradient(90, red, blue)", Syntax::CSS, {} },
+            { "linear-gradient(hsl(0 100% 50%), red)", Syntax::CSS, {} },
+            { "<linearGradient><stop offset='0' stop-color='red'/><stop offset='100%' style='stop-color: blue; stop-opacity: 0.5'/></linearGradient>", Syntax::SVG,
+                { { {{ 1, 0, 0, 1 }}, 0.f }, { {{ 0, 0, 1, 0.5f }}, 1.f } } },
+            { "<linearGradient><stop offset='0' stop-color='currentColor'/><stop offset='1' stop-color='red'/></linearGradient>", Syntax::SVG, {} },
+        };
+    }
+
+    /// @brief Parse case with GradientReader, invalid text has to be counted in errors()
+    inline bool parse_case(const ParseCase& parse) {
+        Gradient::Format::GradientReader reader(parse.text, parse.syntax);
+        LinearN<4> output;
+        const bool read = reader.next(output);
+
+        if (parse.keys.empty())
+            return !read && reader.errors() == 1;
+        return read && reader.errors() == 0 && close_keys<4>(parse.keys, output, 1e-6f, 1e-6f, 1e-6f);
+    }
+
+    /// @brief Round trip random RGB and RGBA gradients and parse fixed cases
+    inline bool verify_formats(size_t iterations, uint32_t seed, size_t max_size, std::map<std::string, FormatStatistics>& statistics) {
+        using Gradient::Format::Syntax;
+        bool passed = true;
+
+        auto record = [&](std::string_view name, bool success, auto&& describe) {
+            FormatStatistics& current = statistics[std::string(name)];
+            current.runs++;
+            if (!success) {
+                current.failures++;
+                passed = false;
+                std::cout << "FORMAT " << name << ": ";
+                describe();
+                std::cout << "\n";
+            }
+        };
+
+        for (Shape shape : shapes) {
+            for (size_t i = 0; i < iterations; i++) {
+                const uint32_t run_seed = seed + static_cast<uint32_t>(i);
+                std::mt19937 rng{ run_seed };
+                const size_t size = std::uniform_int_distribution<size_t>(2, max_size)(rng);
+
+                // Parsers clamp channels as CSS and SVG do
+                LinearN<3> rgb = generate<3>(shape, rng, size);
+                LinearN<4> rgba = generate<4>(shape, rng, size);
+                clamp_colors<3>(rgb);
+                clamp_colors<4>(rgba);
+                auto describe = [&]() { std::cout << to_string(shape) << " input of " << size << " keys, seed " << run_seed; };
+
+                record("CSS round trip", round_trip<3>(rgb, Syntax::CSS) && round_trip<4>(rgba, Syntax::CSS), describe);
+                record("SVG round trip", round_trip<3>(rgb, Syntax::SVG) && round_trip<4>(rgba, Syntax::SVG), describe);
+            }
+        }
+
+        for (const auto& parse : parse_cases())
+            record("Parse cases", parse_case(parse), [&]() { std::cout << parse.text; });
+
+        return passed;
+    }
+
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <algorithm>
+#include <random>
+#include <string_view>
+#include <vector>
+
+#include "gradient/linear.hpp"
+
+namespace ItG::Verify {
+
+    /// @brief Color with N channels
+    template<size_t N>
+    using ColorN = std::array<float, N>;
+
+    /// @brief Linear gradient of colors with N channels
+    template<size_t N>
+    using LinearN = std::vector< Gradient::Key< ColorN<N> > >;
+
+    /// @brief Kind of generated input
+    enum class Shape {
+        Smooth,
+        Banded,
+        Noisy,
+        Adversarial
+    };
+
+    constexpr std::array<Shape, 4> shapes{ Shape::Smooth, Shape::Banded, Shape::Noisy, Shape::Adversarial };
+
+    constexpr std::string_view to_string(Shape shape) {
+        switch (shape) {
+        case Shape::Smooth: return "smooth";
+        case Shape::Banded: return "banded";
+        case Shape::Noisy: return "noisy";
+        case Shape::Adversarial: return "adversarial";
+        }
+        return "unknown";
+    }
+
+    template<size_t N>
+    ColorN<N> random_color(std::mt19937& rng) {
+        std::uniform_real_distribution<float> channel(0.f, 1.f);
+        ColorN<N> color;
+        for (auto& value : color)
+            value = channel(rng);
+        return color;
+    }
+
+    /// @brief Piecewise linear gradient through random colors
+    template<size_t N>
+    LinearN<N> smooth(std::mt19937& rng, size_t size) {
+        const size_t segments = std::uniform_int_distribution<size_t>(1, 8)(rng);
+
+        std::vector< ColorN<N> > anchors;
+        for (size_t i = 0; i <= segments; i++)
+            anchors.push_back(random_color<N>(rng));
+
+        LinearN<N> gradient;
+        gradient.reserve(size);
+        for (size_t i = 0; i < size; i++) {
+            const float position = float(i) / (size - 1);
+            const float segment = position * segments;
+            const size_t index = std::min(static_cast<size_t>(segment), segments - 1);
+
+            ColorN<N> color;
+            for (size_t c = 0; c < N; c++)
+                color[c] = std::lerp(anchors[index][c], anchors[index + 1][c], segment - index);
+            gradient.emplace_back(color, position);
+        }
+        return gradient;
+    }
+
+    /// @brief Runs of identical colors with hard edges
+    template<size_t N>
+    LinearN<N> banded(std::mt19937& rng, size_t size) {
+        const size_t bands = std::uniform_int_distribution<size_t>(1, 12)(rng);
+
+        LinearN<N> gradient;
+        gradient.reserve(size);
+        ColorN<N> color = random_color<N>(rng);
+        for (size_t i = 0; i < size; i++) {
+            if (std::uniform_int_distribution<size_t>(0, size)(rng) < bands)
+                color = random_color<N>(rng);
+            gradient.emplace_back(color, float(i) / (size - 1));
+        }
+        return gradient;
+    }
+
+    /// @brief Smooth gradient with per-sample noise
+    template<size_t N>
+    LinearN<N> noisy(std::mt19937& rng, size_t size) {
+        const float amplitude = std::uniform_real_distribution<float>(0.f, 16.f / 255.f)(rng);
+        std::uniform_real_distribution<float> noise(-amplitude, amplitude);
+
+        LinearN<N> gradient = smooth<N>(rng, size);
+        for (auto& key : gradient)
+            for (auto& value : key.color)
+                value = std::clamp(value + noise(rng), 0.f, 1.f);
+        return gradient;
+    }
+
+    /// @brief Edge cases: constant lines, zigzags at tolerance level, single sample steps and repeated positions
+    template<size_t N>
+    LinearN<N> adversarial(std::mt19937& rng, size_t size) {
+        LinearN<N> gradient;
+        gradient.reserve(size);
+
+        const ColorN<N> base = random_color<N>(rng);
+        const int kind = std::uniform_int_distribution<int>(0, 3)(rng);
+        for (size_t i = 0; i < size; i++) {
+            float position = float(i) / (size - 1);
+            ColorN<N> color = base;
+            switch (kind) {
+            case 0: // constant
+                break;
+            case 1: // zigzag around default tolerance
+                for (auto& value : color)
+                    value += (i % 2 ? 4.f : -4.f) / 255.f;
+                break;
+            case 2: // single sample steps
+                for (auto& value : color)
+                    value = (i % 7 == 3) ? 1.f - value : value;
+                break;
+            case 3: // hard edges with repeated positions
+                position = float(i / 2 * 2) / (size - 1);
+                for (auto& value : color)
+                    value = (i / 2) % 2 ? value : 1.f - value;
+                break;
+            }
+            gradient.emplace_back(color, std::min(position, 1.f));
+        }
+        return gradient;
+    }
+
+    template<size_t N>
+    LinearN<N> generate(Shape shape, std::mt19937& rng, size_t size) {
+        switch (shape) {
+        case Shape::Smooth: return smooth<N>(rng, size);
+        case Shape::Banded: return banded<N>(rng, size);
+        case Shape::Noisy: return noisy<N>(rng, size);
+        case Shape::Adversarial: return adversarial<N>(rng, size);
+        }
+        return {};
+    }
+
+}
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <charconv>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <string_view>
+
+#include "generators.hpp"
+#include "gradient/evaluate.hpp"
+
+namespace ItG::Verify {
+
+    /// @brief Reference and optimized implementation expected to extract the same keys
+    template<size_t N>
+    struct Check {
+        std::string_view name;
+        std::function< LinearN<N>(LinearN<N>&) > reference;
+        std::function< LinearN<N>(LinearN<N>&) > candidate;
+    };
+
+    /// @brief Implementation expected to keep the original within tolerance, checked with Gradient::measure
+    template<size_t N>
+    struct Bound {
+        std::string_view name;
+        std::function< LinearN<N>(LinearN<N>&) > fit;
+        float tolerance = 4.f / 255.f;
+        /// @brief Line the fitted keys have to keep within tolerance, input itself when empty
+        std::function< LinearN<N>(const LinearN<N>&) > original = {};
+    };
+
+    /// @brief Allowed excess over tolerance, fitting and evaluation interpolate with different float rounding
+    constexpr float rounding_slack = 1e-5f;
+
+    /// @brief Accumulated results of a bound
+    struct BoundStatistics {
+        size_t runs = 0;
+        size_t violations = 0;
+        /// @brief Maximal error relative to tolerance
+        float max_ratio = 0.f;
+    };
+
+    /// @brief Accumulated results of a check
+    struct Statistics {
+        size_t runs = 0;
+        size_t mismatches = 0;
+        std::chrono::duration<double> reference_time{};
+        std::chrono::duration<double> candidate_time{};
+        double min_speedup = std::numeric_limits<double>::max();
+        double max_speedup = 0.;
+
+        [[nodiscard]] double speedup() const {
+            return candidate_time.count() > 0. ? reference_time.count() / candidate_time.count() : 0.;
+        }
+    };
+
+    template<size_t N>
+    bool same_keys(LinearN<N>& input, const Check<N>& check) {
+        return check.reference(input) == check.candidate(input);
+    }
+
+    /// @brief Run both implementations, record timing and return true if keys are equal
+    template<size_t N>
+    bool run(LinearN<N>& input, const Check<N>& check, Statistics& statistics) {
+        using Clock = std::chrono::steady_clock;
+
+        auto reference_start = Clock::now();
+        LinearN<N> expected = check.reference(input);
+        auto candidate_start = Clock::now();
+        LinearN<N> actual = check.candidate(input);
+        auto candidate_end = Clock::now();
+
+        const std::chrono::duration<double> reference_time = candidate_start - reference_start;
+        const std::chrono::duration<double> candidate_time = candidate_end - candidate_start;
+
+        statistics.runs++;
+        statistics.reference_time += reference_time;
+        statistics.candidate_time += candidate_time;
+        if (candidate_time.count() > 0.) {
+            const double speedup = reference_time / candidate_time;
+            statistics.min_speedup = std::min(statistics.min_speedup, speedup);
+            statistics.max_speedup = std::max(statistics.max_speedup, speedup);
+        }
+
+        const bool same = expected == actual;
+        if (!same)
+            statistics.mismatches++;
+        return same;
+    }
+
+    template<size_t N>
+    float max_error(LinearN<N>& input, const Bound<N>& bound) {
+        const LinearN<N> keys = bound.fit(input);
+        // Input is never empty, fit signals a failed expectation with no keys
+        if (keys.empty())
+            return std::numeric_limits<float>::infinity();
+
+        if (bound.original)
+            return Gradient::measure(keys, bound.original(input)).max_error();
+        return Gradient::measure(keys, input).max_error();
+    }
+
+    /// @brief Fit input, record error and return true if it's within tolerance
+    template<size_t N>
+    bool run(LinearN<N>& input, const Bound<N>& bound, BoundStatistics& statistics) {
+        const float error = max_error(input, bound);
+
+        statistics.runs++;
+        if (bound.tolerance > 0.f)
+            statistics.max_ratio = std::max(statistics.max_ratio, error / bound.tolerance);
+
+        const bool within = error <= bound.tolerance + rounding_slack;
+        if (!within)
+            statistics.violations++;
+        return within;
+    }
+
+    /// @brief Remove keys from failing input while it still fails
+    /// @param failing Callable bool(LinearN<N>&)
+    template<size_t N, typename Failing>
+    LinearN<N> minimize(LinearN<N> input, Failing&& failing) {
+        for (size_t chunk = input.size() / 2; chunk > 0; chunk /= 2) {
+            bool removed = true;
+            while (removed) {
+                removed = false;
+                for (size_t first = 0; first + chunk <= input.size() && input.size() - chunk >= 2; ) {
+                    LinearN<N> candidate;
+                    candidate.reserve(input.size() - chunk);
+                    for (size_t i = 0; i < input.size(); i++) {
+                        if (i < first || i >= first + chunk)
+                            candidate.emplace_back(input[i]);
+                    }
+
+                    if (failing(candidate)) {
+                        input.swap(candidate);
+                        removed = true;
+                    } else {
+                        first += chunk;
+                    }
+                }
+            }
+        }
+        return input;
+    }
+
+    inline void print_number(std::ostream& stream, float value) {
+        // Shortest representation that reads back to the same value
+        char buffer[32];
+        auto [end, error] = std::to_chars(std::begin(buffer), std::end(buffer), value);
+        stream << std::string_view(buffer, end) << 'f';
+    }
+
+    /// @brief Print gradient as C++ initializer to be pasted into a reproducer
+    template<size_t N>
+    void print(std::ostream& stream, const LinearN<N>& gradient) {
+        stream << "{\n";
+        for (const auto& key : gradient) {
+            stream << "    { {{ ";
+            for (size_t i = 0; i < N; i++) {
+                if (i > 0)
+                    stream << ", ";
+                print_number(stream, key.color[i]);
+            }
+            stream << " }}, ";
+            print_number(stream, key.position);
+            stream << " },\n";
+        }
+        stream << "}";
+    }
+
+    template<size_t N>
+    void report(std::ostream& stream, LinearN<N>& input, const Check<N>& check, Shape shape, uint32_t seed) {
+        LinearN<N> reproducer = minimize(input, [&](LinearN<N>& candidate) { return !same_keys(candidate, check); });
+
+        stream << "MISMATCH " << check.name << ": " << N << " channels, " << to_string(shape) << " input of " << input.size()
+            << " keys, seed " << seed << ", minimized to " << reproducer.size() << " keys\n";
+        stream << "input = ";
+        print<N>(stream, reproducer);
+        stream << ";\nreference = ";
+        print<N>(stream, check.reference(reproducer));
+        stream << ";\ncandidate = ";
+        print<N>(stream, check.candidate(reproducer));
+        stream << ";\n";
+    }
+
+    template<size_t N>
+    void report(std::ostream& stream, LinearN<N>& input, const Bound<N>& bound, Shape shape, uint32_t seed) {
+        const float error = max_error(input, bound);
+        LinearN<N> reproducer = minimize(input, [&](LinearN<N>& candidate) { return !(max_error(candidate, bound) <= bound.tolerance + rounding_slack); });
+
+        stream << "VIOLATION " << bound.name << ": " << N << " channels, " << to_string(shape) << " input of " << input.size()
+            << " keys, seed " << seed << ", error " << error << " over tolerance " << bound.tolerance << ", minimized to " << reproducer.size() << " keys\n";
+        stream << "input = ";
+        print<N>(stream, reproducer);
+        stream << ";\nfitted = ";
+        print<N>(stream, bound.fit(reproducer));
+        stream << ";\n";
+    }
+
+}
@@ -0,0 +1,319 @@
+﻿#include <algorithm>
+#include <charconv>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "gradient.hpp"
+#include "harness.hpp"
+#include "formats.hpp"
+
+using namespace ItG;
+using namespace ItG::Verify;
+
+/// @brief Lines of different lengths cut from input, so lanes of a batch start and finish sections at different keys
+template<size_t N>
+std::vector< LinearN<N> > batch_of(const LinearN<N>& input) {
+    std::vector< LinearN<N> > lines;
+    for (size_t i = 0; i < 11; i++)
+        lines.emplace_back(input.begin() + i * input.size() / 11, input.end());
+    return lines;
+}
+
+/// @brief Keys of all lines one after another
+template<size_t N>
+LinearN<N> concatenate(const std::vector< LinearN<N> >& lines) {
+    LinearN<N> result;
+    for (const auto& line : lines) {
+        for (const auto& key : line)
+            result.emplace_back(key);
+    }
+    return result;
+}
+
+/// @brief Next frame of a line, input with colors of a short span moved by a quarter.
+/// Span covers whole positions, keys sharing a position stay equal.
+template<size_t N>
+LinearN<N> changed_frame(const LinearN<N>& input) {
+    LinearN<N> frame;
+    const size_t first = input.size() / 3, last = first + std::max<size_t>(input.size() / 16, 1) - 1;
+    for (size_t i = 0; i < input.size(); i++) {
+        auto color = input[i].color;
+        if (input[i].position >= input[first].position && input[i].position <= input[last].position) {
+            for (auto& channel : color)
+                channel += channel < 0.5f ? 0.25f : -0.25f;
+        }
+        frame.emplace_back(color, input[i].position);
+    }
+    return frame;
+}
+
+/// @brief Reference strategies paired with implementations that must extract the same keys
+template<size_t N>
+std::vector< Check<N> > checks() {
+    using namespace Gradient;
+
+    return {
+        {
+            "Approximate/ApproximateRecurse",
+            [](LinearN<N>& input) { return from_gradient<Operator::MaxDifference>(input, Strategy::Approximate{}); },
+            [](LinearN<N>& input) { return from_gradient<Operator::MaxDifference>(input, Strategy::ApproximateRecurse{}); }
+        },
+        {
+            "Approximate/Anytime",
+            [](LinearN<N>& input) { return from_gradient<Operator::MaxDifference>(input, Strategy::Approximate{}); },
+            [](LinearN<N>& input) { return from_gradient<Operator::MaxDifference>(input, Strategy::Anytime{}); }
+        },
+        {
+            "Approximate/Collapsed",
+            [](LinearN<N>& input) { return from_gradient<Operator::MaxDifference>(input, Strategy::Approximate{}); },
+            [](LinearN<N>& input) { return from_gradient<Operator::MaxDifference>(input, Strategy::Collapsed{}); }
+        },
+        {
+            "Approximate/Auto",
+            [](LinearN<N>& input) { return from_gradient<Operator::MaxDifference>(input, Strategy::Approximate{}); },
+            [](LinearN<N>& input) { return from_gradient<Operator::MaxDifference>(input, Strategy::Auto{}); }
+        },
+        {
+            "ColorCount/Collapsed",
+            [](LinearN<N>& input) { return from_gradient<Operator::MaxDifference>(input, Strategy::ColorCount{ .count = 6 }); },
+            [](LinearN<N>& input) { return from_gradient<Operator::MaxDifference>(input, Strategy::Collapsed<Strategy::ColorCount>{ .inner = { .count = 6 } }); }
+        },
+        {
+            "ColorCount/Auto",
+            [](LinearN<N>& input) { return from_gradient<Operator::MaxDifference>(input, Strategy::ColorCount{ .count = 6 }); },
+            [](LinearN<N>& input) { return from_gradient<Operator::MaxDifference>(input, Strategy::Auto{ .count = 6 }); }
+        },
+        {
+            "StepCount/Collapsed",
+            [](LinearN<N>& input) { return from_gradient<Operator::MaxDifference>(input, Strategy::StepCount{ .count = 3 }); },
+            [](LinearN<N>& input) { return from_gradient<Operator::MaxDifference>(input, Strategy::Collapsed<Strategy::StepCount>{ .inner = { .count = 3 } }); }
+        },
+        {
+            "Approximate/ApproximateBatch",
+            [](LinearN<N>& input) {
+                auto lines = batch_of(input);
+                std::vector< LinearN<N> > outputs(lines.size());
+                for (size_t i = 0; i < lines.size(); i++)
+                    from_gradient_into<Operator::MaxDifference>(lines[i], outputs[i], {}, Strategy::Approximate{});
+                return concatenate(outputs);
+            },
+            [](LinearN<N>& input) {
+                auto lines = batch_of(input);
+                std::vector< LinearN<N> > outputs(lines.size());
+                from_gradients<Operator::MaxDifference>(std::span(lines), std::span(outputs), {}, Strategy::Approximate{});
+                return concatenate(outputs);
+            }
+        },
+        {
+            "Approximate/Sequence",
+            [](LinearN<N>& input) { return from_gradient<Operator::MaxDifference>(input, Strategy::Approximate{}); },
+            [](LinearN<N>& input) {
+                // Second frame is unchanged and reuses keys of the first
+                Sequence<Operator::MaxDifference, Strategy::Approximate, LinearN<N>> sequence;
+                LinearN<N> keys;
+                sequence(input, keys);
+                sequence(input, keys);
+                return keys;
+            }
+        },
+        {
+            "Approximate/Refine",
+            [](LinearN<N>& input) { return from_gradient<Operator::MaxDifference>(input, Strategy::Approximate{}); },
+            [](LinearN<N>& input) {
+                // Single interval between the ends is split as Approximate splits the whole gradient
+                const LinearN<N> ends{ input.front(), input.back() };
+                return refine<Operator::MaxDifference>(input, ends, { .threads = 2, .min_intervals = 1 });
+            }
+        },
+        {
+            "from_gradient/from_gradient_into",
+            [](LinearN<N>& input) {
+                Builder<LinearN<N>> builder{ .out_range = { { 0.25f, 0.75f } } };
+                return from_gradient<Operator::MaxDifference>(input, builder, Strategy::Approximate{});
+            },
+            [](LinearN<N>& input) {
+                // Reused between runs like a worker would
+                static LinearN<N> storage;
+                storage.resize(std::max(storage.size(), input.size()));
+
+                const Builder<LinearN<N>> builder{ .out_range = { { 0.25f, 0.75f } } };
+                auto keys = from_gradient_into<Operator::MaxDifference, Strategy::Approximate>(input, std::span(storage), builder);
+                return LinearN<N>(keys.begin(), keys.end());
+            }
+        },
+    };
+}
+
+/// @brief Strategies whose keys only have to keep the original within tolerance, measured by evaluating them at every original key
+template<size_t N>
+std::vector< Bound<N> > bounds() {
+    using namespace Gradient;
+
+    return {
+        { "Approximate", [](LinearN<N>& input) { return from_gradient<Operator::MaxDifference>(input, Strategy::Approximate{}); } },
+        { "ApproximateRecurse", [](LinearN<N>& input) { return from_gradient<Operator::MaxDifference>(input, Strategy::ApproximateRecurse{}); } },
+        { "Anytime", [](LinearN<N>& input) { return from_gradient<Operator::MaxDifference>(input, Strategy::Anytime{}); } },
+        { "Collapsed", [](LinearN<N>& input) { return from_gradient<Operator::MaxDifference>(input, Strategy::Collapsed{}); } },
+        { "Auto", [](LinearN<N>& input) { return from_gradient<Operator::MaxDifference>(input, Strategy::Auto{}); } },
+        // Small coarse size, so verify inputs take the coarse-to-fine path from 128 keys on
+        { "Multiresolution", [](LinearN<N>& input) { return from_gradient<Operator::MaxDifference>(input, Strategy::Multiresolution{ .coarse_size = 64 }); } },
+        {
+            "Collapsed<Multiresolution>",
+            [](LinearN<N>& input) { return from_gradient<Operator::MaxDifference>(input, Strategy::Collapsed<Strategy::Multiresolution>{ .inner = { .coarse_size = 64 } }); }
+        },
+        {
+            "Sequence, partial refit",
+            [](LinearN<N>& input) {
+                Sequence<Operator::MaxDifference, Strategy::Approximate, LinearN<N>> sequence;
+                // Never fitted from scratch, the changed span takes the partial path
+                sequence.full_refit = std::numeric_limits<float>::infinity();
+
+                LinearN<N> keys;
+                sequence(input, keys);
+                if (sequence(changed_frame(input), keys) != decltype(sequence)::Change::Partial)
+                    keys.clear();
+                return keys;
+            },
+            4.f / 255.f,
+            [](const LinearN<N>& input) { return changed_frame(input); }
+        },
+        {
+            "Refine from 1/2 tolerance",
+            [](LinearN<N>& input) {
+                // Denser previous keys, intervals are merged over several rounds
+                const auto previous = from_gradient<Operator::MaxDifference>(input, Strategy::Approximate{ .tolerance = 2.f / 255.f });
+                return refine<Operator::MaxDifference>(input, previous, { .threads = 4, .min_intervals = 1 });
+            }
+        },
+        {
+            "Refine from 3/2 tolerance",
+            [](LinearN<N>& input) {
+                // Sparser previous keys, violating intervals are split
+                const auto previous = from_gradient<Operator::MaxDifference>(input, Strategy::Approximate{ .tolerance = 6.f / 255.f });
+                return refine<Operator::MaxDifference>(input, previous, { .threads = 4, .min_intervals = 1 });
+            }
+        },
+        { "Streaming", [](LinearN<N>& input) { return from_gradient<Operator::MaxDifference>(input, Strategy::Streaming{}); } },
+        {
+            "Streaming window 3, pushed",
+            [](LinearN<N>& input) {
+                // Keys one by one as a stream would deliver them, short window forces early commits
+                LinearN<N> keys;
+                auto fitter = Strategy::stream_fitter< Key< ColorN<N> > >({ .window = 3 }, [&](const auto& key) { keys.emplace_back(key); });
+                for (const auto& key : input)
+                    fitter.push(key);
+                fitter.finish();
+                return keys;
+            }
+        },
+        {
+            "Streaming window 2, 1/255",
+            [](LinearN<N>& input) { return from_gradient<Operator::MaxDifference>(input, Strategy::Streaming{ .tolerance = 1.f / 255.f, .window = 2 }); },
+            1.f / 255.f
+        },
+        {
+            "Approximate 1/255",
+            [](LinearN<N>& input) { return from_gradient<Operator::MaxDifference>(input, Strategy::Approximate{ .tolerance = 1.f / 255.f }); },
+            1.f / 255.f
+        },
+    };
+}
+
+template<size_t N>
+bool verify(size_t iterations, uint32_t seed, size_t max_size, std::map<std::string, Statistics>& statistics, std::map<std::string, BoundStatistics>& bound_statistics) {
+    bool passed = true;
+
+    for (const auto& check : checks<N>()) {
+        Statistics& current = statistics[std::string(check.name)];
+
+        for (Shape shape : shapes) {
+            for (size_t i = 0; i < iterations; i++) {
+                const uint32_t run_seed = seed + static_cast<uint32_t>(i);
+                std::mt19937 rng{ run_seed };
+                const size_t size = std::uniform_int_distribution<size_t>(2, max_size)(rng);
+
+                LinearN<N> input = generate<N>(shape, rng, size);
+                if (!run<N>(input, check, current)) {
+                    report<N>(std::cout, input, check, shape, run_seed);
+                    passed = false;
+                }
+            }
+        }
+    }
+
+    for (const auto& bound : bounds<N>()) {
+        BoundStatistics& current = bound_statistics[std::string(bound.name)];
+
+        for (Shape shape : shapes) {
+            for (size_t i = 0; i < iterations; i++) {
+                const uint32_t run_seed = seed + static_cast<uint32_t>(i);
+                std::mt19937 rng{ run_seed };
+                const size_t size = std::uniform_int_distribution<size_t>(2, max_size)(rng);
+
+                LinearN<N> input = generate<N>(shape, rng, size);
+                if (!run<N>(input, bound, current)) {
+                    report<N>(std::cout, input, bound, shape, run_seed);
+                    passed = false;
+                }
+            }
+        }
+    }
+
+    return passed;
+}
+
+template<size_t... N>
+bool verify_all(std::index_sequence<N...>, size_t iterations, uint32_t seed, size_t max_size, std::map<std::string, Statistics>& statistics, std::map<std::string, BoundStatistics>& bound_statistics) {
+    // Channel counts 1..5
+    return (verify<N + 1>(iterations, seed, max_size, statistics, bound_statistics) & ...);
+}
+
+/// @brief Parse whole argument as unsigned number
+template<typename T>
+bool parse_number(std::string_view text, T& value) {
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc{} && end == text.data() + text.size();
+}
+
+int main(int argc, char** argv) {
+    size_t iterations = 100;
+    uint32_t seed = 1;
+    size_t max_size = 2000;
+
+    if (argc > 4
+        || (argc > 1 && !parse_number(argv[1], iterations))
+        || (argc > 2 && !parse_number(argv[2], seed))
+        || (argc > 3 && !parse_number(argv[3], max_size))) {
+        std::cout << "Usage: itg-verify [iterations] [seed] [max_size]";
+        return 1;
+    }
+    max_size = std::max<size_t>(max_size, 2);
+
+    std::map<std::string, Statistics> statistics;
+    std::map<std::string, BoundStatistics> bound_statistics;
+    std::map<std::string, FormatStatistics> format_statistics;
+    const bool passed = verify_all(std::make_index_sequence<5>{}, iterations, seed, max_size, statistics, bound_statistics)
+        & verify_formats(iterations, seed, max_size, format_statistics);
+
+    for (const auto& [name, current] : statistics) {
+        std::cout << name << ": " << current.runs << " runs, " << current.mismatches << " mismatches, speedup "
+            << current.speedup() << "x (min " << current.min_speedup << "x, max " << current.max_speedup << "x)" << std::endl;
+    }
+
+    for (const auto& [name, current] : bound_statistics) {
+        std::cout << name << ": " << current.runs << " runs, " << current.violations << " over tolerance, max error "
+            << current.max_ratio << "x tolerance" << std::endl;
+    }
+
+    for (const auto& [name, current] : format_statistics)
+        std::cout << name << ": " << current.runs << " runs, " << current.failures << " failures" << std::endl;
+
+    std::cout << (passed ? "PASSED" : "FAILED") << std::endl;
+    return passed ? 0 : 1;
+}